@@ -9,6 +9,46 @@
 #include <omp.h>
 #include <random>
 #include <iomanip> // Para formatear la salida
+#include <cstdint> // Para uint32_t en las máscaras de bits
+#include <memory>
+#include <string>
+#include <deque>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <sstream>
+#include <cctype>
+#include <type_traits>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>       // _open/_write/_close
+#else
+#include <sys/mman.h> // mmap para leer los lotes sin copiarlos
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/socket.h> // Socket de dominio Unix del modo servicio
+#include <sys/un.h>
+#include <poll.h>
+#include <csignal>
+#endif
+#ifdef __linux__
+#include <sched.h>   // sched_getaffinity y cpu_set_t para ubicar los hilos
+#include <pthread.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h> // Para _BitScanForward y __popcnt
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+#define SUDOKU_AVX2
+#include <immintrin.h> // Núcleos AVX2, elegidos en tiempo de ejecución
+#endif
 
 
 
@@ -22,365 +62,5809 @@ std::mutex mtx;
 const int N9x9 = 9;
 const int N16x16 = 16;
 const int N25x25 = 25;
+const int N36x36 = 36;
+const int N49x49 = 49;
+const int N64x64 = 64;
 const int NUM_HILOS = 8;
+const int TAMANO_BLOQUE_LOTE = 1 << 16; // Puzzles que se leen y resuelven por bloque en modo lote
+const int CHUNK_LOTE = 64;              // Puzzles que toma un hilo en cada reparto dinámico
 
+// Motores de resolución que puede usar resolverSudoku
+enum class Motor {
+    Clasico,  // Backtracking original con isSafe sobre el tablero
+    Bitmask,  // Backtracking con una máscara de bits por fila, columna y subcuadrícula
+    MRV,        // Máscaras de bits ramificando siempre en la celda con menos candidatos
+    Propagacion,// Propagación de restricciones en cada nodo más MRV
+    DLX,        // Cobertura exacta con Dancing Links (Algoritmo X)
+    Paralelo,   // Propagación en paralelo con un pool de hilos y robo de trabajo
+    Portafolio  // Un hilo por estrategia compitiendo por el mismo puzzle; gana el primero
+};
+
+// Dimensión máxima de los tableros; define el tamaño de los arreglos fijos de los estados
+const int MAX_DIMENSION = N64x64;
+const int MAX_CELDAS = MAX_DIMENSION * MAX_DIMENSION;
+
+// Tablero plano y contiguo, fila a fila, con capacidad para la dimensión máxima.
+// Vive en la pila o dentro de otras estructuras sin pedir memoria dinámica.
+struct Tablero {
+    int size = 0;
+    uint8_t celdas[MAX_CELDAS];
+
+    uint8_t& en(int row, int col) { return celdas[row * size + col]; }
+    uint8_t en(int row, int col) const { return celdas[row * size + col]; }
+};
+
+// Instrumentación detallada de la búsqueda (retrocesos, profundidad, hipótesis por nivel,
+// eliminaciones, tiempos por hilo y traza muestreada). Está activa en las compilaciones de
+// depuración y desaparece por completo con NDEBUG, salvo que se pida con
+// -DSUDOKU_INSTRUMENTACION=1 (o se apague con =0).
+#ifndef SUDOKU_INSTRUMENTACION
+#ifdef NDEBUG
+#define SUDOKU_INSTRUMENTACION 0
+#else
+#define SUDOKU_INSTRUMENTACION 1
+#endif
+#endif
+#if SUDOKU_INSTRUMENTACION
+#define INSTRUMENTAR(...) __VA_ARGS__
+#else
+#define INSTRUMENTAR(...)
+#endif
+
+const int NIVELES_INSTRUMENTADOS = 32; // Las hipótesis más profundas se juntan en el último
+
+// Contadores de cuánto aporta cada técnica de propagación
+struct EstadisticasPropagacion {
+    long long nakedSingles = 0;   // Celdas con un único candidato
+    long long hiddenSingles = 0;  // Números con un único lugar posible en una unidad
+    long long pointing = 0;       // Candidatos eliminados por bloqueo dentro de una subcuadrícula
+    long long claiming = 0;       // Candidatos eliminados por bloqueo dentro de una fila o columna
+    long long nodos = 0;          // Nodos visitados por el backtracking
+    long long ramificaciones = 0; // Hipótesis probadas al ramificar
+#if SUDOKU_INSTRUMENTACION
+    long long retrocesos = 0;     // Ramas que terminaron en contradicción
+    long long eliminaciones = 0;  // Candidatos descartados por la propagación
+    int profundidadMaxima = 0;
+    long long hipotesisPorNivel[NIVELES_INSTRUMENTADOS] = {};
+    long long robos = 0;          // Tareas robadas a otro hilo (motor paralelo)
+    double ocupadoNs = 0;         // Resolviendo tareas
+    double ociosoNs = 0;          // Esperando trabajo
+    double roboNs = 0;            // Buscando trabajo en las colas ajenas
+#endif
+};
+
+// Contadores de un hilo en su propia línea de caché: en los vectores por hilo dos hilos nunca
+// escriben en la misma línea (sin false sharing). Se suman al terminar.
+struct alignas(64) ContadoresHilo {
+    EstadisticasPropagacion stats;
+    long long soluciones = 0;
+};
+
+// Nanosegundos transcurridos desde `inicio` con el reloj monótono
+double nanosegundosDesde(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+#if SUDOKU_INSTRUMENTACION
+// Registra un nodo (con su profundidad) y, si ramifica, la hipótesis en su nivel
+inline void registrarNodo(EstadisticasPropagacion& stats, int profundidad) {
+    if (profundidad > stats.profundidadMaxima) stats.profundidadMaxima = profundidad;
+}
+
+inline void registrarHipotesis(EstadisticasPropagacion& stats, int profundidad) {
+    stats.hipotesisPorNivel[std::min(profundidad, NIVELES_INSTRUMENTADOS - 1)]++;
+}
+
+// Traza muestreada de la forma del árbol: uno de cada `muestreoTraza` nodos deja un evento en el
+// buffer de su hilo; volcarTraza los escribe todos como CSV para analizarlos aparte.
+long long muestreoTraza = 0; // 0: sin traza
+
+struct EventoTraza {
+    int hilo;
+    int profundidad;
+    int celda;      // Celda en la que se ramifica; -1 en las hojas
+    int hijos;      // Candidatos de esa celda
+    char resultado; // 'r' ramifica, 'c' contradicción, 's' solución
+};
+
+struct BufferTraza {
+    int hilo = 0;
+    long long visitados = 0;
+    std::vector<EventoTraza> eventos;
+};
+
+std::mutex mtxTraza;
+std::vector<std::unique_ptr<BufferTraza>> buffersTraza;
+
+// Buffer del hilo actual; se registra la primera vez, así que solo hay lock al crearlo
+BufferTraza& bufferTrazaHilo() {
+    thread_local BufferTraza* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> guard(mtxTraza);
+        buffersTraza.emplace_back(new BufferTraza());
+        buffer = buffersTraza.back().get();
+        buffer->hilo = buffersTraza.size() - 1;
+    }
+    return *buffer;
+}
+
+inline void trazar(int profundidad, int celda, int hijos, char resultado) {
+    if (muestreoTraza <= 0) return;
+    BufferTraza& buffer = bufferTrazaHilo();
+    if (buffer.visitados++ % muestreoTraza != 0) return;
+    buffer.eventos.push_back({ buffer.hilo, profundidad, celda, hijos, resultado });
+}
+
+inline void registrarRetroceso(EstadisticasPropagacion& stats, int profundidad) {
+    stats.retrocesos++;
+    trazar(profundidad, -1, 0, 'c');
+}
+
+bool volcarTraza(const std::string& ruta) {
+    std::ofstream archivo(ruta);
+    archivo << "hilo,profundidad,celda,hijos,resultado" << std::endl;
+    std::lock_guard<std::mutex> guard(mtxTraza);
+    for (const auto& buffer : buffersTraza) {
+        for (const EventoTraza& e : buffer->eventos) {
+            archivo << e.hilo << "," << e.profundidad << "," << e.celda << "," << e.hijos << "," << e.resultado << "\n";
+        }
+    }
+    return static_cast<bool>(archivo);
+}
+#endif
+
+
+
+
+// Función para imprimir el tablero de Sudoku en un formato adecuado
+void printBoardCuadricula(const Tablero& board) {
+    int size = board.size;
+    int subSize = static_cast<int>(std::sqrt(size)); // Tamaño de cada subcuadrícula
+    int ancho = static_cast<int>(std::to_string(size).size()); // Cifras del número más grande
+
+    std::cout << "Tablero de Sudoku resuelto:\n";
+    for (int i = 0; i < size; i++) {
+        if (i % subSize == 0 && i != 0) {
+            // Línea divisoria: cada celda ocupa ancho + 1 y cada separador 3
+            std::cout << std::string(size * (ancho + 1) + 3 * (subSize - 1), '-') << "\n";
+        }
+        for (int j = 0; j < size; j++) {
+            if (j % subSize == 0 && j != 0) {
+                std::cout << " | "; // Separador de subcuadrículas
+            }
+            std::cout << std::setw(ancho) << static_cast<int>(board.en(i, j)) << " ";
+        }
+        std::cout << "\n";
+    }
+}
+
+// Función para verificar si es seguro colocar un número en una celda en Sudoku de cualquier tamaño.
+// B es el lado de la subcuadrícula; con la dimensión conocida al compilar los ciclos se desenrollan.
+template <int B>
+bool isSafe(const Tablero& board, int row, int col, int num) {
+    constexpr int size = B * B;
+    const uint8_t* fila = &board.celdas[row * size];
+    // Verificar la fila
+    for (int x = 0; x < size; x++) {
+        if (fila[x] == num) {
+            return false;
+        }
+    }
+    // Verificar la columna
+    for (int x = 0; x < size; x++) {
+        if (board.celdas[x * size + col] == num) {
+            return false;
+        }
+    }
+    // Verificar la subcuadrícula
+    int startRow = row - row % B;
+    int startCol = col - col % B;
+    for (int i = 0; i < B; i++) {
+        for (int j = 0; j < B; j++) {
+            if (board.celdas[(startRow + i) * size + startCol + j] == num) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Algoritmo de backtracking con poda. Cuenta como nodo cada celda vacía que se intenta llenar.
+template <int B>
+bool solveSudoku(Tablero& board, int row, int col, EstadisticasPropagacion& stats) {
+    constexpr int size = B * B;
+    // Si hemos llegado al final del tablero
+    if (row == size) return true;
+    // Si la columna se sale de los límites, pasa a la siguiente fila
+    if (col == size) return solveSudoku<B>(board, row + 1, 0, stats);
+    // Si la celda ya tiene un valor, pasa a la siguiente
+    if (board.celdas[row * size + col] != 0) return solveSudoku<B>(board, row, col + 1, stats);
+
+    stats.nodos++;
+    // Poda: verificar números válidos en la posición actual
+    for (int num = 1; num <= size; num++) {
+        if (isSafe<B>(board, row, col, num)) {
+            board.celdas[row * size + col] = num; // Colocar el número provisionalmente
+            stats.ramificaciones++;
+            if (solveSudoku<B>(board, row, col + 1, stats)) return true; // Avanza
+            board.celdas[row * size + col] = 0; // Backtrack: quitar el número
+            INSTRUMENTAR(stats.retrocesos++);
+        }
+    }
+    return false; // Si no hay ninguna opción válida, se devuelve falso
+}
+
+// Función para copiar un tablero de ejemplo al tablero plano; false si no cabe o no es cuadrado
+bool cargarTablero(const std::vector<std::vector<int>>& initialBoard, Tablero& board) {
+    int size = initialBoard.size();
+    if (size == 0 || size > MAX_DIMENSION) return false;
+    board.size = size;
+    for (int i = 0; i < size; i++) {
+        if (static_cast<int>(initialBoard[i].size()) != size) return false;
+        for (int j = 0; j < size; j++) {
+            if (initialBoard[i][j] < 0 || initialBoard[i][j] > size) return false;
+            board.en(i, j) = static_cast<uint8_t>(initialBoard[i][j]);
+        }
+    }
+    return true;
+}
+
+// Escribe el tablero como objeto JSON, sin vaciar el flujo. Con conMarca se agrega el campo
+// "resuelto" antes de las celdas.
+void escribirTableroJSON(const Tablero& board, std::ostream& os, bool conMarca = false, bool resuelto = false) {
+    int size = board.size;
+    os << "{\n";
+    if (conMarca) os << "\t\"resuelto\": " << (resuelto ? "true" : "false") << ",\n";
+    os << "\t\"board\": [\n";
+    for (int i = 0; i < size; i++) {
+        os << "\t\t[";
+        for (int j = 0; j < size; j++) {
+            os << static_cast<int>(board.en(i, j));
+            if (j != size - 1) os << ", ";
+        }
+        os << "]";
+        if (i != size - 1) os << ",";
+        os << '\n';
+    }
+    os << "\t]\n";
+    os << "}\n";
+}
+
+// Función para imprimir el tablero de Sudoku
+void printBoard(const Tablero& board) {
+    escribirTableroJSON(board, std::cout);
+    std::cout.flush(); // Un solo vaciado al final del tablero
+}
+
+// Índice del bit encendido más bajo (la máscara no puede ser 0)
+inline int bitMasBajo(uint32_t mascara) {
+#ifdef _MSC_VER
+    unsigned long indice;
+    _BitScanForward(&indice, mascara);
+    return static_cast<int>(indice);
+#else
+    return __builtin_ctz(mascara);
+#endif
+}
+
+// Cantidad de bits encendidos en la máscara
+inline int contarBits(uint32_t mascara) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt(mascara));
+#else
+    return __builtin_popcount(mascara);
+#endif
+}
+
+// Versiones de 64 bits para los tableros de más de 32 números
+inline int bitMasBajo(uint64_t mascara) {
+#ifdef _MSC_VER
+    unsigned long indice;
+    _BitScanForward64(&indice, mascara);
+    return static_cast<int>(indice);
+#else
+    return __builtin_ctzll(mascara);
+#endif
+}
+
+inline int contarBits(uint64_t mascara) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(mascara));
+#else
+    return __builtin_popcountll(mascara);
+#endif
+}
+
+// Datos del tablero que solo dependen del orden B (subcuadrículas de BxB, dimensión B*B).
+// Todo es constante de compilación, así que los ciclos sobre size, subSize o los vecinos
+// tienen cotas fijas y el compilador puede desenrollarlos.
+template <int B>
+struct Topologia {
+    static constexpr int subSize = B;
+    static constexpr int size = B * B;
+    static constexpr int total = size * size;
+    static constexpr int numVecinos = 2 * (size - 1) + (subSize - 1) * (subSize - 1);
+    // Un bit por número: uint32_t alcanza hasta 25x25; de 36x36 a 64x64 se usan 64 bits
+    using Mascara = typename std::conditional<(size > 32), uint64_t, uint32_t>::type;
+    static constexpr Mascara completo = ~Mascara(0) >> (8 * sizeof(Mascara) - size);
+    // Los núcleos AVX2 usan máscaras de 32 bits y al menos dos registros por unidad
+    static constexpr bool simd = size >= 16 && size <= 32;
+    // Hasta 36x36 la lista de vecinos de cada celda ocupa poco (250 KB); en 49x49 y 64x64
+    // pasaría de medio mega y dejaría de caber en caché junto a los estados, así que ahí
+    // los vecinos se recorren a partir de las unidades
+    static constexpr bool vecinosEnTabla = B <= 6;
+};
+
+// Vecinos (misma fila, columna o subcuadrícula, sin repetidos) de cada celda y las 3*size
+// unidades de size celdas: filas, columnas y subcuadrículas
+template <int B>
+struct TablasTopologia {
+    int16_t vecinos[Topologia<B>::vecinosEnTabla ? Topologia<B>::total : 1][Topologia<B>::numVecinos];
+    int16_t unidades[3 * Topologia<B>::size][Topologia<B>::size];
+};
+
+template <int B>
+constexpr TablasTopologia<B> construirTablas() {
+    constexpr int size = Topologia<B>::size;
+    TablasTopologia<B> tablas{};
+    for (int row = 0; row < (Topologia<B>::vecinosEnTabla ? size : 0); row++) {
+        for (int col = 0; col < size; col++) {
+            int16_t* vecinos = tablas.vecinos[row * size + col];
+            int k = 0;
+            for (int x = 0; x < size; x++) {
+                if (x != col) vecinos[k++] = static_cast<int16_t>(row * size + x);
+            }
+            for (int x = 0; x < size; x++) {
+                if (x != row) vecinos[k++] = static_cast<int16_t>(x * size + col);
+            }
+            int startRow = row - row % B;
+            int startCol = col - col % B;
+            for (int i = startRow; i < startRow + B; i++) {
+                for (int j = startCol; j < startCol + B; j++) {
+                    // Las celdas de la misma fila o columna ya se agregaron
+                    if (i != row && j != col) vecinos[k++] = static_cast<int16_t>(i * size + j);
+                }
+            }
+        }
+    }
+    for (int u = 0; u < size; u++) {
+        int startRow = (u / B) * B;
+        int startCol = (u % B) * B;
+        for (int x = 0; x < size; x++) {
+            tablas.unidades[u][x] = static_cast<int16_t>(u * size + x);
+            tablas.unidades[size + u][x] = static_cast<int16_t>(x * size + u);
+            tablas.unidades[2 * size + u][x] = static_cast<int16_t>((startRow + x / B) * size + startCol + x % B);
+        }
+    }
+    return tablas;
+}
+
+// Las tablas de cada orden se calculan al compilar y quedan en la sección de solo lectura
+template <int B>
+constexpr TablasTopologia<B> tablasTopologia = construirTablas<B>();
+
+// Llama a f con cada vecino de pos, en el mismo orden que la tabla: la fila, la columna y
+// el resto de la subcuadrícula
+template <int B, typename F>
+inline void paraCadaVecino(int pos, F&& f) {
+    using T = Topologia<B>;
+    if constexpr (T::vecinosEnTabla) {
+        const int16_t* vecino = tablasTopologia<B>.vecinos[pos];
+        for (int k = 0; k < T::numVecinos; k++) f(vecino[k]);
+    }
+    else {
+        int row = pos / T::size;
+        int col = pos % T::size;
+        for (int x = 0; x < T::size; x++) {
+            if (x != col) f(row * T::size + x);
+        }
+        for (int x = 0; x < T::size; x++) {
+            if (x != row) f(x * T::size + col);
+        }
+        int startRow = row - row % B;
+        int startCol = col - col % B;
+        for (int i = startRow; i < startRow + B; i++) {
+            for (int j = startCol; j < startCol + B; j++) {
+                if (i != row && j != col) f(i * T::size + j);
+            }
+        }
+    }
+}
+
+// Llama a f con std::integral_constant<int, B> según la dimensión del tablero, para elegir
+// en tiempo de ejecución la instanciación del solver. Devuelve false si no hay una.
+template <typename F>
+bool despacharOrden(int size, F&& f) {
+    switch (size) {
+    case N9x9: return f(std::integral_constant<int, 3>());
+    case N16x16: return f(std::integral_constant<int, 4>());
+    case N25x25: return f(std::integral_constant<int, 5>());
+    case N36x36: return f(std::integral_constant<int, 6>());
+    case N49x49: return f(std::integral_constant<int, 7>());
+    case N64x64: return f(std::integral_constant<int, 8>());
+    default: return false;
+    }
+}
+
+// Núcleos vectoriales. Para 16x16 y 25x25 (máscaras de 32 bits) hay una versión AVX2 de
+// cada uno y otra escalar; la AVX2 se compila con el atributo de destino, así que el binario
+// corre en cualquier x86-64 y elige en tiempo de ejecución según la CPU.
+#ifdef SUDOKU_AVX2
+#ifdef _MSC_VER
+#define OBJETIVO_AVX2
+#else
+#define OBJETIVO_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+bool cpuTieneAVX2() {
+#if defined(SUDOKU_AVX2) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    // El sistema debe guardar los registros YMM al cambiar de contexto
+    return osxsave && avx2 && (_xgetbv(0) & 6) == 6;
+#elif defined(SUDOKU_AVX2)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// Se decide una vez al arrancar; --escalar lo apaga para comparar con la versión escalar
+bool usarAVX2 = cpuTieneAVX2();
+
+// Índices de las celdas de las unidades agrupadas de a 8 para recorrerlas con gathers:
+// indices[g][k][l] es la celda k de la unidad 8*g + l. Las posiciones sobrantes del último
+// grupo repiten la unidad 0 y su resultado se descarta.
+template <int B>
+struct IndicesUnidadesSimd {
+    static constexpr int grupos = (3 * Topologia<B>::size + 7) / 8;
+    int32_t indices[grupos][Topologia<B>::size][8];
+};
+
+template <int B>
+constexpr IndicesUnidadesSimd<B> construirIndicesSimd() {
+    constexpr int size = Topologia<B>::size;
+    IndicesUnidadesSimd<B> tabla{};
+    for (int g = 0; g < IndicesUnidadesSimd<B>::grupos; g++) {
+        for (int k = 0; k < size; k++) {
+            for (int l = 0; l < 8; l++) {
+                int u = 8 * g + l < 3 * size ? 8 * g + l : 0;
+                tabla.indices[g][k][l] = tablasTopologia<B>.unidades[u][k];
+            }
+        }
+    }
+    return tabla;
+}
+
+template <int B>
+constexpr IndicesUnidadesSimd<B> indicesUnidadesSimd = construirIndicesSimd<B>();
+
+// Candidatos de todas las celdas a partir de las máscaras de cada fila, columna y
+// subcuadrícula; las celdas con valor quedan con el bit de su número. False si alguna
+// celda vacía se queda sin candidatos.
+template <int B>
+bool candidatosEnBloqueEscalar(const typename Topologia<B>::Mascara* filas, const typename Topologia<B>::Mascara* columnas,
+    const typename Topologia<B>::Mascara* cajas, const uint8_t* celdas, typename Topologia<B>::Mascara* candidatos) {
+    using T = Topologia<B>;
+    using Mascara = typename T::Mascara;
+    for (int row = 0; row < T::size; row++) {
+        for (int col = 0; col < T::size; col++) {
+            int pos = row * T::size + col;
+            if (celdas[pos] != 0) {
+                candidatos[pos] = Mascara(1) << (celdas[pos] - 1);
+                continue;
+            }
+            candidatos[pos] = T::completo & ~(filas[row] | columnas[col] | cajas[(row / B) * B + col / B]);
+            if (candidatos[pos] == 0) return false;
+        }
+    }
+    return true;
+}
+
+#ifdef SUDOKU_AVX2
+// Misma cuenta de a 8 celdas por fila: la máscara de la fila se replica en todo el registro,
+// las de las columnas se leen contiguas y las de las subcuadrículas se expanden a una por
+// columna una vez por banda. Las columnas que no completan un registro van por la vía escalar.
+template <int B>
+OBJETIVO_AVX2 bool candidatosEnBloqueAVX2(const uint32_t* filas, const uint32_t* columnas, const uint32_t* cajas,
+    const uint8_t* celdas, uint32_t* candidatos) {
+    using T = Topologia<B>;
+    constexpr int enteros = T::size / 8 * 8;
+    uint32_t cajaPorColumna[T::size];
+    const __m256i completo = _mm256_set1_epi32(static_cast<int>(T::completo));
+    const __m256i uno = _mm256_set1_epi32(1);
+    const __m256i cero = _mm256_setzero_si256();
+    __m256i vacias = cero;
+    for (int row = 0; row < T::size; row++) {
+        if (row % B == 0) {
+            for (int col = 0; col < T::size; col++) cajaPorColumna[col] = cajas[(row / B) * B + col / B];
+        }
+        const __m256i fila = _mm256_set1_epi32(static_cast<int>(filas[row]));
+        for (int col = 0; col < enteros; col += 8) {
+            int pos = row * T::size + col;
+            __m256i valor = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(celdas + pos)));
+            __m256i usados = _mm256_or_si256(fila, _mm256_or_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columnas + col)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cajaPorColumna + col))));
+            __m256i libres = _mm256_andnot_si256(usados, completo);
+            // En las celdas vacías el desplazamiento es -1 y sllv da 0
+            __m256i propio = _mm256_sllv_epi32(uno, _mm256_sub_epi32(valor, uno));
+            __m256i resultado = _mm256_blendv_epi8(libres, propio, _mm256_cmpgt_epi32(valor, cero));
+            vacias = _mm256_or_si256(vacias, _mm256_cmpeq_epi32(resultado, cero));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(candidatos + pos), resultado);
+        }
+        for (int col = enteros; col < T::size; col++) {
+            int pos = row * T::size + col;
+            if (celdas[pos] != 0) {
+                candidatos[pos] = 1u << (celdas[pos] - 1);
+                continue;
+            }
+            candidatos[pos] = T::completo & ~(filas[row] | columnas[col] | cajaPorColumna[col]);
+            if (candidatos[pos] == 0) return false;
+        }
+    }
+    return _mm256_testz_si256(vacias, vacias) != 0;
+}
+
+// Recorre 8 unidades a la vez (una por carril) y deja en unicos[u] los números que solo
+// tienen un lugar en la unidad u. Se llama cuando los naked singles ya no encuentran nada,
+// así que ninguna celda vacía tiene un solo candidato y una máscara de un bit indica una
+// celda resuelta. False si a alguna unidad le falta lugar para algún número.
+template <int B>
+OBJETIVO_AVX2 bool unidadesConUnicosAVX2(const uint32_t* candidatos, uint32_t* unicos) {
+    using T = Topologia<B>;
+    constexpr int grupos = IndicesUnidadesSimd<B>::grupos;
+    const __m256i completo = _mm256_set1_epi32(static_cast<int>(T::completo));
+    const __m256i uno = _mm256_set1_epi32(1);
+    const __m256i cero = _mm256_setzero_si256();
+    const int* base = reinterpret_cast<const int*>(candidatos);
+    __m256i faltan = cero;
+    alignas(32) uint32_t grupo[8];
+    for (int g = 0; g < grupos; g++) {
+        __m256i unaVez = cero, variasVeces = cero, colocados = cero;
+        for (int k = 0; k < T::size; k++) {
+            __m256i indice = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indicesUnidadesSimd<B>.indices[g][k]));
+            __m256i c = _mm256_i32gather_epi32(base, indice, 4);
+            __m256i resuelta = _mm256_cmpeq_epi32(_mm256_and_si256(c, _mm256_sub_epi32(c, uno)), cero);
+            __m256i libre = _mm256_andnot_si256(resuelta, c);
+            colocados = _mm256_or_si256(colocados, _mm256_and_si256(resuelta, c));
+            variasVeces = _mm256_or_si256(variasVeces, _mm256_and_si256(unaVez, libre));
+            unaVez = _mm256_or_si256(unaVez, libre);
+        }
+        faltan = _mm256_or_si256(faltan, _mm256_xor_si256(_mm256_or_si256(unaVez, colocados), completo));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(grupo),
+            _mm256_andnot_si256(colocados, _mm256_andnot_si256(variasVeces, unaVez)));
+        for (int l = 0; l < 8 && 8 * g + l < 3 * T::size; l++) unicos[8 * g + l] = grupo[l];
+    }
+    return _mm256_testz_si256(faltan, faltan) != 0;
+}
+
+// Tablero completo válido: cada fila, columna y subcuadrícula tiene todos los números.
+// Las filas se reducen dentro del registro y las columnas y subcuadrículas acumulando
+// registros de filas sucesivas.
+template <int B>
+OBJETIVO_AVX2 bool validarSolucionAVX2(const uint8_t* celdas) {
+    using T = Topologia<B>;
+    constexpr int registros = T::size / 8;
+    constexpr int enteros = registros * 8;
+    const __m256i uno = _mm256_set1_epi32(1);
+    __m256i columnas[registros];
+    __m256i bandas[registros];
+    uint32_t columnasResto[T::size - enteros + 1] = {};
+    uint32_t bandasResto[T::size - enteros + 1] = {};
+    alignas(32) uint32_t banda[enteros + 8];
+    for (int r = 0; r < registros; r++) columnas[r] = bandas[r] = _mm256_setzero_si256();
+
+    for (int row = 0; row < T::size; row++) {
+        __m256i filaVec = _mm256_setzero_si256();
+        uint32_t fila = 0;
+        for (int r = 0; r < registros; r++) {
+            __m256i valor = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(celdas + row * T::size + 8 * r)));
+            // Un 0 da desplazamiento -1 y queda sin bit; un valor fuera de rango queda fuera de completo
+            __m256i bit = _mm256_sllv_epi32(uno, _mm256_sub_epi32(valor, uno));
+            filaVec = _mm256_or_si256(filaVec, bit);
+            columnas[r] = _mm256_or_si256(columnas[r], bit);
+            bandas[r] = _mm256_or_si256(bandas[r], bit);
+        }
+        for (int col = enteros; col < T::size; col++) {
+            int valor = celdas[row * T::size + col];
+            uint32_t bit = (valor >= 1 && valor <= 32) ? 1u << (valor - 1) : 0;
+            fila |= bit;
+            columnasResto[col - enteros] |= bit;
+            bandasResto[col - enteros] |= bit;
+        }
+        __m128i mitad = _mm_or_si128(_mm256_castsi256_si128(filaVec), _mm256_extracti128_si256(filaVec, 1));
+        mitad = _mm_or_si128(mitad, _mm_shuffle_epi32(mitad, 0x4E));
+        mitad = _mm_or_si128(mitad, _mm_shuffle_epi32(mitad, 0xB1));
+        fila |= static_cast<uint32_t>(_mm_cvtsi128_si32(mitad));
+        if (fila != T::completo) return false;
+
+        if (row % B == B - 1) {
+            // Cierre de una banda: cada subcuadrícula reúne B columnas consecutivas
+            for (int r = 0; r < registros; r++) {
+                _mm256_store_si256(reinterpret_cast<__m256i*>(banda + 8 * r), bandas[r]);
+                bandas[r] = _mm256_setzero_si256();
+            }
+            for (int col = enteros; col < T::size; col++) {
+                banda[col] = bandasResto[col - enteros];
+                bandasResto[col - enteros] = 0;
+            }
+            for (int b = 0; b < B; b++) {
+                uint32_t caja = 0;
+                for (int j = 0; j < B; j++) caja |= banda[b * B + j];
+                if (caja != T::completo) return false;
+            }
+        }
+    }
+
+    const __m256i completo = _mm256_set1_epi32(static_cast<int>(T::completo));
+    for (int r = 0; r < registros; r++) {
+        __m256i distinto = _mm256_xor_si256(columnas[r], completo);
+        if (!_mm256_testz_si256(distinto, distinto)) return false;
+    }
+    for (int col = enteros; col < T::size; col++) {
+        if (columnasResto[col - enteros] != T::completo) return false;
+    }
+    return true;
+}
+#endif
+
+template <int B>
+bool validarSolucionEscalar(const uint8_t* celdas) {
+    using T = Topologia<B>;
+    using Mascara = typename T::Mascara;
+    for (int u = 0; u < 3 * T::size; u++) {
+        Mascara vistos = 0;
+        for (int k = 0; k < T::size; k++) {
+            int valor = celdas[tablasTopologia<B>.unidades[u][k]];
+            if (valor < 1 || valor > T::size) return false;
+            vistos |= Mascara(1) << (valor - 1);
+        }
+        if (vistos != T::completo) return false;
+    }
+    return true;
+}
+
+// Eligen la versión AVX2 cuando el orden la tiene y la CPU la soporta
+template <int B>
+bool candidatosEnBloque(const typename Topologia<B>::Mascara* filas, const typename Topologia<B>::Mascara* columnas,
+    const typename Topologia<B>::Mascara* cajas, const uint8_t* celdas, typename Topologia<B>::Mascara* candidatos) {
+#ifdef SUDOKU_AVX2
+    if constexpr (Topologia<B>::simd) {
+        if (usarAVX2) return candidatosEnBloqueAVX2<B>(filas, columnas, cajas, celdas, candidatos);
+    }
+#endif
+    return candidatosEnBloqueEscalar<B>(filas, columnas, cajas, celdas, candidatos);
+}
+
+template <int B>
+bool validarSolucion(const uint8_t* celdas) {
+#ifdef SUDOKU_AVX2
+    if constexpr (Topologia<B>::simd) {
+        if (usarAVX2) return validarSolucionAVX2<B>(celdas);
+    }
+#endif
+    return validarSolucionEscalar<B>(celdas);
+}
+
+// Estado del solver con una máscara de bits por fila, columna y subcuadrícula.
+// El bit (num - 1) está encendido si el número num ya aparece en esa unidad,
+// así que los candidatos de una celda son ~(fila | columna | caja).
+template <int B>
+struct EstadoBitmask {
+    using T = Topologia<B>;
+    using Mascara = typename T::Mascara;
+    uint8_t celdas[T::total];     // Tablero plano, fila a fila
+    Mascara filas[T::size];
+    Mascara columnas[T::size];
+    Mascara cajas[T::size];
+
+    static int caja(int row, int col) {
+        return (row / B) * B + col / B;
+    }
+
+    Mascara candidatos(int row, int col) const {
+        return T::completo & ~(filas[row] | columnas[col] | cajas[caja(row, col)]);
+    }
+
+    void colocar(int row, int col, int num) {
+        Mascara bit = Mascara(1) << (num - 1);
+        filas[row] |= bit;
+        columnas[col] |= bit;
+        cajas[caja(row, col)] |= bit;
+        celdas[row * T::size + col] = num;
+    }
+
+    void quitar(int row, int col, int num) {
+        Mascara bit = Mascara(1) << (num - 1);
+        filas[row] &= ~bit;
+        columnas[col] &= ~bit;
+        cajas[caja(row, col)] &= ~bit;
+        celdas[row * T::size + col] = 0;
+    }
+};
+
+// Carga el tablero inicial en el estado; devuelve false si las pistas se contradicen
+template <int B>
+bool inicializarEstado(EstadoBitmask<B>& estado, const Tablero& board) {
+    using T = Topologia<B>;
+    for (int k = 0; k < T::size; k++) {
+        estado.filas[k] = estado.columnas[k] = estado.cajas[k] = 0;
+    }
+    std::memset(estado.celdas, 0, T::total);
+
+    for (int i = 0; i < T::size; i++) {
+        for (int j = 0; j < T::size; j++) {
+            int num = board.celdas[i * T::size + j];
+            if (num == 0) continue;
+            if (num > T::size) return false;
+            if (!(estado.candidatos(i, j) & (typename T::Mascara(1) << (num - 1)))) return false;
+            estado.colocar(i, j, num);
+        }
+    }
+    return true;
+}
+
+// Backtracking en orden fila a fila usando las máscaras en lugar de isSafe
+template <int B>
+bool solveSudokuBitmask(EstadoBitmask<B>& estado, int pos) {
+    using T = Topologia<B>;
+    // Saltar las celdas que ya tienen valor
+    while (pos < T::total && estado.celdas[pos] != 0) pos++;
+    if (pos == T::total) return true;
+
+    int row = pos / T::size;
+    int col = pos % T::size;
+    typename T::Mascara candidatos = estado.candidatos(row, col);
+    while (candidatos) {
+        int num = bitMasBajo(candidatos) + 1;
+        candidatos &= candidatos - 1; // Apagar el bit ya probado
+        estado.colocar(row, col, num);
+        if (solveSudokuBitmask(estado, pos + 1)) return true;
+        estado.quitar(row, col, num);
+    }
+    return false;
+}
+
+// Copia las celdas del estado al tablero
+template <int B>
+void copiarEstado(const EstadoBitmask<B>& estado, Tablero& board) {
+    std::memcpy(board.celdas, estado.celdas, Topologia<B>::total);
+}
+
+// Estado para MRV: además de las máscaras guarda cuántos candidatos le quedan
+// a cada celda vacía y los actualiza al colocar y quitar, sin recalcularlos.
+template <int B>
+struct EstadoMRV {
+    using T = Topologia<B>;
+    EstadoBitmask<B> base;
+    int conteo[T::total];     // Candidatos restantes de cada celda vacía
+    int vacias[T::total];     // Celdas vacías; las primeras `profundidad` ya están asignadas
+    int numVacias = 0;
+    long long nodos = 0;      // Nodos visitados desde inicializarEstado
+
+    typename T::Mascara candidatos(int pos) const {
+        return base.candidatos(pos / T::size, pos % T::size);
+    }
+};
+
+template <int B>
+bool inicializarEstado(EstadoMRV<B>& estado, const Tablero& board) {
+    estado.nodos = 0;
+    if (!inicializarEstado(estado.base, board)) return false;
+    estado.numVacias = 0;
+    for (int pos = 0; pos < Topologia<B>::total; pos++) {
+        if (estado.base.celdas[pos] != 0) continue;
+        estado.conteo[pos] = contarBits(estado.candidatos(pos));
+        // Una celda sin candidatos desde el inicio hace imposible el tablero
+        if (estado.conteo[pos] == 0) return false;
+        estado.vacias[estado.numVacias++] = pos;
+    }
+    return true;
+}
+
+// Coloca num en pos y descuenta el candidato en los vecinos vacíos que lo tenían.
+// Devuelve false si algún vecino se queda sin candidatos; aun así deja el estado
+// completo para que quitarMRV lo revierta.
+template <int B>
+bool colocarMRV(EstadoMRV<B>& estado, int pos, int num) {
+    using T = Topologia<B>;
+    typename T::Mascara bit = typename T::Mascara(1) << (num - 1);
+    bool valido = true;
+    paraCadaVecino<B>(pos, [&](int v) {
+        if (estado.base.celdas[v] == 0 && (estado.candidatos(v) & bit)) {
+            if (--estado.conteo[v] == 0) valido = false;
+        }
+    });
+    estado.base.colocar(pos / T::size, pos % T::size, num);
+    return valido;
+}
+
+// Deshace colocarMRV devolviendo el candidato a los vecinos que lo recuperan
+template <int B>
+void quitarMRV(EstadoMRV<B>& estado, int pos, int num) {
+    using T = Topologia<B>;
+    typename T::Mascara bit = typename T::Mascara(1) << (num - 1);
+    estado.base.quitar(pos / T::size, pos % T::size, num);
+    paraCadaVecino<B>(pos, [&](int v) {
+        if (estado.base.celdas[v] == 0 && (estado.candidatos(v) & bit)) {
+            estado.conteo[v]++;
+        }
+    });
+}
+
+// El control de la búsqueda se define con los límites de resolución, más adelante
+struct ControlBusqueda;
+bool revisarControl(ControlBusqueda& control, long long nodos);
+
+// Backtracking que siempre ramifica en la celda vacía con menos candidatos. Si se pasa un
+// control, lo revisa en cada nodo (presupuesto, token y plazo) y abandona si este lo indica.
+template <int B>
+bool solveSudokuMRV(EstadoMRV<B>& estado, int profundidad, ControlBusqueda* control = nullptr) {
+    if (control && revisarControl(*control, estado.nodos)) return false;
+    estado.nodos++;
+    int total = estado.numVacias;
+    if (profundidad == total) return true;
+
+    // Buscar la celda con menos candidatos entre las que faltan
+    int mejor = profundidad;
+    int minimo = estado.conteo[estado.vacias[profundidad]];
+    for (int i = profundidad + 1; i < total && minimo > 1; i++) {
+        int c = estado.conteo[estado.vacias[i]];
+        if (c < minimo) {
+            minimo = c;
+            mejor = i;
+        }
+    }
+    std::swap(estado.vacias[profundidad], estado.vacias[mejor]);
+    int pos = estado.vacias[profundidad];
+
+    typename Topologia<B>::Mascara candidatos = estado.candidatos(pos);
+    while (candidatos) {
+        int num = bitMasBajo(candidatos) + 1;
+        candidatos &= candidatos - 1;
+        if (colocarMRV(estado, pos, num) && solveSudokuMRV(estado, profundidad + 1, control)) return true;
+        quitarMRV(estado, pos, num);
+    }
+    return false;
+}
+
+// Estado con los candidatos de cada celda. A diferencia de las máscaras por unidad,
+// permite eliminaciones que no vienen de un número colocado (candidatos bloqueados).
+// Las celdas ya resueltas guardan como candidato solo el bit de su valor. Mide
+// exactamente lo que necesita su orden, así que copiarlo es un memcpy del tamaño justo.
+template <int B>
+struct EstadoPropagacion {
+    uint8_t celdas[Topologia<B>::total];
+    typename Topologia<B>::Mascara candidatos[Topologia<B>::total];
+    int vacias = 0;
+};
+
+// Un estado por nivel de la búsqueda con propagación. Los niveles se crean la primera vez
+// que se alcanzan y se reutilizan en los puzzles siguientes; deque no mueve los que ya
+// existen al crecer, así que las referencias de los niveles superiores siguen válidas.
+template <int B>
+struct PilaEstados {
+    std::deque<EstadoPropagacion<B>> niveles;
+
+    EstadoPropagacion<B>& nivel(int profundidad) {
+        while (static_cast<int>(niveles.size()) <= profundidad) niveles.emplace_back();
+        return niveles[profundidad];
+    }
+};
+
+// Coloca num en pos y lo elimina de los vecinos; false si algún vecino queda sin candidatos
+template <int B>
+bool asignar(EstadoPropagacion<B>& estado, int pos, int num) {
+    using T = Topologia<B>;
+    using Mascara = typename T::Mascara;
+    Mascara bit = Mascara(1) << (num - 1);
+    if (!(estado.candidatos[pos] & bit)) return false;
+    estado.celdas[pos] = num;
+    estado.candidatos[pos] = bit;
+    estado.vacias--;
+    bool valido = true;
+    paraCadaVecino<B>(pos, [&](int v) {
+        Mascara& c = estado.candidatos[v];
+        c &= ~bit;
+        valido &= (c != 0);
+    });
+    return valido;
+}
+
+// Arma las máscaras de cada unidad con las pistas y calcula todos los candidatos de una vez,
+// en lugar de asignar pista por pista recorriendo sus vecinos
+template <int B>
+bool inicializarEstado(EstadoPropagacion<B>& estado, const Tablero& board) {
+    using T = Topologia<B>;
+    using Mascara = typename T::Mascara;
+    Mascara filas[T::size] = {}, columnas[T::size] = {}, cajas[T::size] = {};
+    std::memcpy(estado.celdas, board.celdas, T::total);
+    estado.vacias = 0;
+    for (int row = 0; row < T::size; row++) {
+        for (int col = 0; col < T::size; col++) {
+            int num = estado.celdas[row * T::size + col];
+            if (num == 0) {
+                estado.vacias++;
+                continue;
+            }
+            if (num > T::size) return false;
+            Mascara bit = Mascara(1) << (num - 1);
+            int caja = (row / B) * B + col / B;
+            // Pista repetida en una unidad
+            if ((filas[row] | columnas[col] | cajas[caja]) & bit) return false;
+            filas[row] |= bit;
+            columnas[col] |= bit;
+            cajas[caja] |= bit;
+        }
+    }
+    return candidatosEnBloque<B>(filas, columnas, cajas, estado.celdas, estado.candidatos);
+}
+
+// Quita los candidatos de `mascara` en las celdas vacías de la lista que no estén en `excluir`
+template <int B>
+bool eliminarEnCeldas(EstadoPropagacion<B>& estado, const int16_t* celdas, int excluirDesde, int excluirHasta,
+    typename Topologia<B>::Mascara mascara, long long& eliminados) {
+    for (int k = 0; k < Topologia<B>::size; k++) {
+        if (k >= excluirDesde && k < excluirHasta) continue;
+        int pos = celdas[k];
+        if (estado.celdas[pos] != 0) continue;
+        typename Topologia<B>::Mascara quitar = estado.candidatos[pos] & mascara;
+        if (!quitar) continue;
+        estado.candidatos[pos] &= ~quitar;
+        eliminados += contarBits(quitar);
+        if (estado.candidatos[pos] == 0) return false;
+    }
+    return true;
+}
+
+// Candidatos bloqueados. Pointing: si dentro de una subcuadrícula un número solo puede ir
+// en una fila (o columna), se elimina del resto de esa fila. Claiming: si dentro de una fila
+// (o columna) un número solo puede ir en una subcuadrícula, se elimina del resto de ella.
+template <int B>
+bool candidatosBloqueados(EstadoPropagacion<B>& estado, EstadisticasPropagacion& stats, bool& cambio) {
+    using T = Topologia<B>;
+    using Mascara = typename T::Mascara;
+    constexpr int size = T::size;
+    constexpr int subSize = T::subSize;
+    const auto& unidades = tablasTopologia<B>.unidades;
+    Mascara franja[subSize];
+
+    for (int b = 0; b < size; b++) {
+        const int16_t* caja = unidades[2 * size + b];
+        int bandaFila = (b / subSize) * subSize;
+        int bandaCol = (b % subSize) * subSize;
+        // Pointing por filas: franja[k] reúne los candidatos de la fila k de la subcuadrícula
+        for (int pasada = 0; pasada < 2; pasada++) {
+            for (int k = 0; k < subSize; k++) franja[k] = 0;
+            for (int i = 0; i < subSize; i++) {
+                for (int j = 0; j < subSize; j++) {
+                    int pos = caja[i * subSize + j];
+                    if (estado.celdas[pos] == 0) franja[pasada == 0 ? i : j] |= estado.candidatos[pos];
+                }
+            }
+            for (int k = 0; k < subSize; k++) {
+                Mascara otras = 0;
+                for (int m = 0; m < subSize; m++) {
+                    if (m != k) otras |= franja[m];
+                }
+                Mascara solo = franja[k] & ~otras;
+                if (!solo) continue;
+                long long antes = stats.pointing;
+                bool ok = (pasada == 0)
+                    ? eliminarEnCeldas(estado, unidades[bandaFila + k], bandaCol, bandaCol + subSize, solo, stats.pointing)
+                    : eliminarEnCeldas(estado, unidades[size + bandaCol + k], bandaFila, bandaFila + subSize, solo, stats.pointing);
+                if (!ok) return false;
+                if (stats.pointing != antes) cambio = true;
+            }
+        }
+    }
+
+    // Claiming: franja[k] reúne los candidatos del tramo de la fila (o columna) dentro de la subcuadrícula k
+    for (int pasada = 0; pasada < 2; pasada++) {
+        for (int linea = 0; linea < size; linea++) {
+            const int16_t* celdas = unidades[pasada * size + linea];
+            for (int k = 0; k < subSize; k++) {
+                franja[k] = 0;
+                for (int x = k * subSize; x < (k + 1) * subSize; x++) {
+                    if (estado.celdas[celdas[x]] == 0) franja[k] |= estado.candidatos[celdas[x]];
+                }
+            }
+            for (int k = 0; k < subSize; k++) {
+                Mascara otras = 0;
+                for (int m = 0; m < subSize; m++) {
+                    if (m != k) otras |= franja[m];
+                }
+                Mascara solo = franja[k] & ~otras;
+                if (!solo) continue;
+                int b = (pasada == 0) ? (linea / subSize) * subSize + k : k * subSize + linea / subSize;
+                const int16_t* caja = unidades[2 * size + b];
+                int desplazamiento = linea % subSize;
+                // Eliminar de las celdas de la subcuadrícula que no están en esta línea
+                for (int i = 0; i < subSize; i++) {
+                    if (i == desplazamiento) continue;
+                    for (int j = 0; j < subSize; j++) {
+                        int pos = (pasada == 0) ? caja[i * subSize + j] : caja[j * subSize + i];
+                        if (estado.celdas[pos] != 0) continue;
+                        Mascara quitar = estado.candidatos[pos] & solo;
+                        if (!quitar) continue;
+                        estado.candidatos[pos] &= ~quitar;
+                        stats.claiming += contarBits(quitar);
+                        cambio = true;
+                        if (estado.candidatos[pos] == 0) return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Hidden singles de la unidad u: asigna los números que solo caben en una de sus celdas.
+// False si a la unidad le falta lugar para algún número.
+template <int B>
+bool hiddenSinglesUnidad(EstadoPropagacion<B>& estado, int u, EstadisticasPropagacion& stats, bool& cambio) {
+    using T = Topologia<B>;
+    using Mascara = typename T::Mascara;
+    const int16_t* celdas = tablasTopologia<B>.unidades[u];
+    Mascara unaVez = 0, variasVeces = 0, colocados = 0;
+    for (int k = 0; k < T::size; k++) {
+        int pos = celdas[k];
+        if (estado.celdas[pos] != 0) {
+            colocados |= estado.candidatos[pos];
+        }
+        else {
+            variasVeces |= unaVez & estado.candidatos[pos];
+            unaVez |= estado.candidatos[pos];
+        }
+    }
+    // Algún número ya no tiene lugar en la unidad
+    if ((unaVez | colocados) != T::completo) return false;
+
+    Mascara unicos = unaVez & ~variasVeces & ~colocados;
+    while (unicos) {
+        int num = bitMasBajo(unicos) + 1;
+        unicos &= unicos - 1;
+        Mascara bit = Mascara(1) << (num - 1);
+        int destino = -1;
+        for (int k = 0; k < T::size; k++) {
+            if (estado.celdas[celdas[k]] == 0 && (estado.candidatos[celdas[k]] & bit)) {
+                destino = celdas[k];
+                break;
+            }
+        }
+        // La única celda posible ya recibió otro número en esta misma pasada
+        if (destino < 0 || !asignar(estado, destino, num)) return false;
+        stats.hiddenSingles++;
+        cambio = true;
+    }
+    return true;
+}
+
+// Aplica naked singles, hidden singles y candidatos bloqueados hasta que no haya cambios.
+// Devuelve false si encuentra una contradicción.
+template <int B>
+bool propagarHastaPuntoFijo(EstadoPropagacion<B>& estado, EstadisticasPropagacion& stats) {
+    using T = Topologia<B>;
+    constexpr int size = T::size;
+    bool cambio = true;
+    while (cambio && estado.vacias > 0) {
+        cambio = false;
+
+        // Naked singles: celdas con un solo candidato
+        for (int pos = 0; pos < T::total; pos++) {
+            if (estado.celdas[pos] == 0 && contarBits(estado.candidatos[pos]) == 1) {
+                if (!asignar(estado, pos, bitMasBajo(estado.candidatos[pos]) + 1)) return false;
+                stats.nakedSingles++;
+                cambio = true;
+            }
+        }
+        if (cambio) continue; // Las reglas baratas primero
+
+        // Hidden singles: números que solo caben en una celda de la unidad. Con AVX2 un
+        // barrido vectorial descarta primero las unidades que no tienen ninguno.
+        bool filtrado = false;
+#ifdef SUDOKU_AVX2
+        if constexpr (T::simd) {
+            if (usarAVX2) {
+                uint32_t unicos[3 * size];
+                if (!unidadesConUnicosAVX2<B>(estado.candidatos, unicos)) return false;
+                for (int u = 0; u < 3 * size; u++) {
+                    if (unicos[u] && !hiddenSinglesUnidad(estado, u, stats, cambio)) return false;
+                }
+                filtrado = true;
+            }
+        }
+#endif
+        if (!filtrado) {
+            for (int u = 0; u < 3 * size; u++) {
+                if (!hiddenSinglesUnidad(estado, u, stats, cambio)) return false;
+            }
+        }
+        if (cambio) continue;
+
+        if (!candidatosBloqueados(estado, stats, cambio)) return false;
+    }
+    return true;
+}
+
+#if SUDOKU_INSTRUMENTACION
+// Candidatos que quedan en todo el tablero (las celdas llenas conservan el suyo)
+template <int B>
+long long candidatosRestantes(const EstadoPropagacion<B>& estado) {
+    long long total = 0;
+    for (int pos = 0; pos < Topologia<B>::total; pos++) total += contarBits(estado.candidatos[pos]);
+    return total;
+}
+#endif
+
+// Propagación hasta el punto fijo; con instrumentación cuenta además los candidatos eliminados
+template <int B>
+bool propagar(EstadoPropagacion<B>& estado, EstadisticasPropagacion& stats) {
+    INSTRUMENTAR(long long antes = candidatosRestantes(estado));
+    bool consistente = propagarHastaPuntoFijo(estado, stats);
+    INSTRUMENTAR(stats.eliminaciones += antes - candidatosRestantes(estado));
+    return consistente;
+}
+
+// Celda vacía con menos candidatos (la primera con dos basta); -1 si no queda ninguna
+template <int B>
+int celdaMasRestringida(const EstadoPropagacion<B>& estado) {
+    int mejor = -1;
+    int minimo = Topologia<B>::size + 1;
+    for (int pos = 0; pos < Topologia<B>::total && minimo > 2; pos++) {
+        if (estado.celdas[pos] != 0) continue;
+        int c = contarBits(estado.candidatos[pos]);
+        if (c < minimo) {
+            minimo = c;
+            mejor = pos;
+        }
+    }
+    return mejor;
+}
+
+// Cómo terminó una resolución
+enum class EstadoResolucion : char { Resuelto, SinSolucion, PlazoVencido, PresupuestoAgotado, Cancelado, Invalido };
+
+const long long LOTE_NODOS_CONTROL = 256; // Nodos que un hilo descuenta de una vez del presupuesto
+
+// Lo que la búsqueda revisa en cada nodo para saber si debe abandonar. La bandera `detener`
+// la enciende el primero que tenga un motivo (el token del llamador, el vigilante de plazos,
+// el presupuesto de nodos o el hilo que juntó las soluciones pedidas) y todos los hilos la
+// ven en su próximo nodo. El presupuesto se descuenta por lotes, así que el contador
+// compartido se toca una vez cada LOTE_NODOS_CONTROL nodos de cada hilo.
+struct ControlBusqueda {
+    std::atomic<bool> detener{ false };
+    std::atomic<EstadoResolucion> motivo{ EstadoResolucion::Resuelto };
+    const std::atomic<bool>* token = nullptr;
+    long long presupuestoNodos = 0; // 0: sin límite
+    std::atomic<long long> nodosConsumidos{ 0 };
+
+    // Estado más avanzado en el que estaba algún hilo al abandonar
+    std::mutex mtxParcial;
+    int vaciasParcial = MAX_CELDAS + 1;
+    Tablero parcial;
+
+    // Enciende la bandera; queda el motivo del primero que llegó
+    void parar(EstadoResolucion causa) {
+        bool esperado = false;
+        if (detener.compare_exchange_strong(esperado, true)) motivo.store(causa);
+    }
+
+    // nodosHilo: nodos que lleva el hilo que pregunta
+    bool revisar(long long nodosHilo) {
+        if (presupuestoNodos > 0 && nodosHilo % LOTE_NODOS_CONTROL == 0 &&
+            nodosConsumidos.fetch_add(LOTE_NODOS_CONTROL, std::memory_order_relaxed) >= presupuestoNodos) {
+            parar(EstadoResolucion::PresupuestoAgotado);
+        }
+        if (token && token->load(std::memory_order_relaxed)) parar(EstadoResolucion::Cancelado);
+        return detener.load(std::memory_order_relaxed);
+    }
+
+    bool detenido() const { return detener.load(std::memory_order_relaxed); }
+
+    template <int B>
+    void guardarParcial(const EstadoPropagacion<B>& estado) {
+        std::lock_guard<std::mutex> guard(mtxParcial);
+        if (estado.vacias >= vaciasParcial) return;
+        vaciasParcial = estado.vacias;
+        parcial.size = Topologia<B>::size;
+        std::memcpy(parcial.celdas, estado.celdas, Topologia<B>::total);
+    }
+};
+
+bool revisarControl(ControlBusqueda& control, long long nodos) {
+    return control.revisar(nodos);
+}
+
+// Hilo único que enciende los controles cuyo plazo venció. Registrar y retirar cuestan un lock
+// y una operación sobre un mapa ordenado por plazo; el hilo duerme hasta el vencimiento más
+// próximo, así que la búsqueda nunca lee el reloj. Como parar() se llama con el lock tomado,
+// después de retirar un control el vigilante ya no lo toca y se puede destruir.
+struct VigilantePlazos {
+    using Reloj = std::chrono::steady_clock;
+    using Clave = std::pair<Reloj::time_point, long long>;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::map<Clave, ControlBusqueda*> plazos;
+    long long siguienteId = 0;
+    bool terminar = false;
+    std::thread hilo;
+
+    VigilantePlazos() : hilo(&VigilantePlazos::vigilar, this) {}
+
+    ~VigilantePlazos() {
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            terminar = true;
+        }
+        cv.notify_one();
+        hilo.join();
+    }
+
+    Clave registrar(Reloj::time_point plazo, ControlBusqueda* control) {
+        std::lock_guard<std::mutex> guard(mtx);
+        Clave clave(plazo, siguienteId++);
+        auto it = plazos.emplace(clave, control).first;
+        if (it == plazos.begin()) cv.notify_one(); // Es el nuevo vencimiento más próximo
+        return clave;
+    }
+
+    // No hace nada si el plazo ya venció y el vigilante lo quitó
+    void retirar(const Clave& clave) {
+        std::lock_guard<std::mutex> guard(mtx);
+        plazos.erase(clave);
+    }
+
+    void vigilar() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!terminar) {
+            if (plazos.empty()) {
+                cv.wait(lock);
+            }
+            else if (Reloj::now() >= plazos.begin()->first.first) {
+                plazos.begin()->second->parar(EstadoResolucion::PlazoVencido);
+                plazos.erase(plazos.begin());
+            }
+            else {
+                cv.wait_until(lock, plazos.begin()->first.first);
+            }
+        }
+    }
+};
+
+// El vigilante arranca la primera vez que alguien pide un plazo
+VigilantePlazos& vigilantePlazos() {
+    static VigilantePlazos vigilante;
+    return vigilante;
+}
+
+// Backtracking que propaga en cada nodo y ramifica en la celda con menos candidatos.
+// Las copias de cada rama salen de la pila de estados, sin memoria dinámica por nodo.
+// Si se pasa un control, la búsqueda abandona en cuanto este lo indica y deja en él el
+// estado en el que iba.
+template <int B>
+bool solveSudokuPropagacion(EstadoPropagacion<B>& estado, PilaEstados<B>& pila, EstadisticasPropagacion& stats,
+    ControlBusqueda* control = nullptr, int profundidad = 0) {
+    if (control && control->revisar(stats.nodos)) {
+        control->guardarParcial(estado);
+        return false;
+    }
+    stats.nodos++;
+    INSTRUMENTAR(registrarNodo(stats, profundidad));
+    if (!propagar(estado, stats)) {
+        INSTRUMENTAR(registrarRetroceso(stats, profundidad));
+        return false;
+    }
+    if (estado.vacias == 0) {
+        INSTRUMENTAR(trazar(profundidad, -1, 0, 's'));
+        return true;
+    }
+
+    int mejor = celdaMasRestringida(estado);
+    EstadoPropagacion<B>& copia = pila.nivel(profundidad);
+    typename Topologia<B>::Mascara candidatos = estado.candidatos[mejor];
+    INSTRUMENTAR(trazar(profundidad, mejor, contarBits(candidatos), 'r'));
+    while (candidatos) {
+        int num = bitMasBajo(candidatos) + 1;
+        candidatos &= candidatos - 1;
+        stats.ramificaciones++;
+        INSTRUMENTAR(registrarHipotesis(stats, profundidad));
+        copia = estado;
+        if (!asignar(copia, mejor, num)) {
+            INSTRUMENTAR(registrarRetroceso(stats, profundidad + 1));
+            continue;
+        }
+        if (solveSudokuPropagacion(copia, pila, stats, control, profundidad + 1)) {
+            estado = copia;
+            return true;
+        }
+        if (control && control->detenido()) return false;
+    }
+    return false;
+}
+
+// Recorre las soluciones del subárbol llamando a alEncontrar con cada una. Se detiene en
+// cuanto alEncontrar devuelve false o el control lo indica; en ese caso devuelve false.
+template <int B, typename F>
+bool enumerarSoluciones(EstadoPropagacion<B>& estado, PilaEstados<B>& pila, EstadisticasPropagacion& stats,
+    F& alEncontrar, ControlBusqueda* control = nullptr, int profundidad = 0) {
+    if (control && control->revisar(stats.nodos)) {
+        control->guardarParcial(estado);
+        return false;
+    }
+    stats.nodos++;
+    INSTRUMENTAR(registrarNodo(stats, profundidad));
+    if (!propagar(estado, stats)) {
+        INSTRUMENTAR(registrarRetroceso(stats, profundidad));
+        return true;
+    }
+    if (estado.vacias == 0) {
+        INSTRUMENTAR(trazar(profundidad, -1, 0, 's'));
+        return alEncontrar(static_cast<const EstadoPropagacion<B>&>(estado));
+    }
+
+    int mejor = celdaMasRestringida(estado);
+    EstadoPropagacion<B>& copia = pila.nivel(profundidad);
+    typename Topologia<B>::Mascara candidatos = estado.candidatos[mejor];
+    INSTRUMENTAR(trazar(profundidad, mejor, contarBits(candidatos), 'r'));
+    while (candidatos) {
+        int num = bitMasBajo(candidatos) + 1;
+        candidatos &= candidatos - 1;
+        stats.ramificaciones++;
+        INSTRUMENTAR(registrarHipotesis(stats, profundidad));
+        copia = estado;
+        if (!asignar(copia, mejor, num)) {
+            INSTRUMENTAR(registrarRetroceso(stats, profundidad + 1));
+            continue;
+        }
+        if (!enumerarSoluciones(copia, pila, stats, alEncontrar, control, profundidad + 1)) return false;
+    }
+    return true;
+}
+
+// Propaga sobre el tablero dejando las celdas deducidas; false si el tablero es contradictorio
+bool propagarTablero(Tablero& board, EstadisticasPropagacion& stats) {
+    return despacharOrden(board.size, [&](auto orden) {
+        constexpr int B = decltype(orden)::value;
+        std::unique_ptr<EstadoPropagacion<B>> estado(new EstadoPropagacion<B>());
+        if (!inicializarEstado(*estado, board) || !propagar(*estado, stats)) return false;
+        std::memcpy(board.celdas, estado->celdas, Topologia<B>::total);
+        return true;
+    });
+}
+
+// Suma los contadores de un hilo o de una etapa al total
+void sumarEstadisticas(EstadisticasPropagacion& total, const EstadisticasPropagacion& parte) {
+    total.nakedSingles += parte.nakedSingles;
+    total.hiddenSingles += parte.hiddenSingles;
+    total.pointing += parte.pointing;
+    total.claiming += parte.claiming;
+    total.nodos += parte.nodos;
+    total.ramificaciones += parte.ramificaciones;
+#if SUDOKU_INSTRUMENTACION
+    total.retrocesos += parte.retrocesos;
+    total.eliminaciones += parte.eliminaciones;
+    total.profundidadMaxima = std::max(total.profundidadMaxima, parte.profundidadMaxima);
+    for (int nivel = 0; nivel < NIVELES_INSTRUMENTADOS; nivel++) total.hipotesisPorNivel[nivel] += parte.hipotesisPorNivel[nivel];
+    total.robos += parte.robos;
+    total.ocupadoNs += parte.ocupadoNs;
+    total.ociosoNs += parte.ociosoNs;
+    total.roboNs += parte.roboNs;
+#endif
+}
+
+// Muestra los contadores de cada técnica
+void imprimirEstadisticas(const EstadisticasPropagacion& stats) {
+    std::cout << "Propagación: " << stats.nakedSingles << " naked singles, "
+        << stats.hiddenSingles << " hidden singles, "
+        << stats.pointing << " eliminaciones pointing, "
+        << stats.claiming << " eliminaciones claiming" << std::endl;
+    std::cout << "Búsqueda: " << stats.nodos << " nodos, " << stats.ramificaciones << " ramificaciones" << std::endl;
+#if SUDOKU_INSTRUMENTACION
+    std::cout << "Detalle: " << stats.retrocesos << " retrocesos, " << stats.eliminaciones
+        << " candidatos eliminados, profundidad máxima " << stats.profundidadMaxima << std::endl;
+    int ultimo = NIVELES_INSTRUMENTADOS - 1;
+    while (ultimo > 0 && stats.hipotesisPorNivel[ultimo] == 0) ultimo--;
+    if (stats.ramificaciones > 0) {
+        std::cout << "Hipótesis por nivel:";
+        for (int nivel = 0; nivel <= ultimo; nivel++) std::cout << " " << stats.hipotesisPorNivel[nivel];
+        std::cout << (ultimo == NIVELES_INSTRUMENTADOS - 1 ? " (el último junta los más profundos)" : "") << std::endl;
+    }
+    if (stats.ocupadoNs + stats.ociosoNs + stats.roboNs > 0) {
+        std::cout << "Hilos (suma): " << std::fixed << std::setprecision(3) << stats.ocupadoNs / 1e6 << " ms ocupados, "
+            << stats.ociosoNs / 1e6 << " ms ociosos, " << stats.roboNs / 1e6 << " ms buscando trabajo ajeno ("
+            << stats.robos << " robos)" << std::defaultfloat << std::endl;
+    }
+#endif
+}
+
+// Matriz de cobertura exacta para Dancing Links. Los nodos viven en arreglos planos
+// indexados en lugar de nodos enlazados en el heap: el 0 es la raíz, 1..columnas son
+// las cabeceras y después vienen las filas (una por terna celda/número, 4 nodos cada una).
+struct MatrizDLX {
+    int size = 0;
+    int columnas = 0;               // 4 * size * size restricciones
+    std::vector<int> izq, der, arriba, abajo;
+    std::vector<int> columna;       // Cabecera a la que pertenece cada nodo
+    std::vector<int> fila;          // Terna (celda * size + num - 1) de cada nodo
+    std::vector<int> tamano;        // Nodos vivos en cada columna
+    std::vector<int> primerNodo;    // Primer nodo de cada fila de la matriz
+    long long nodos = 0;            // Nodos visitados por la última búsqueda
+};
+
+MatrizDLX construirMatrizDLX(int size) {
+    int subSize = static_cast<int>(std::sqrt(size));
+    int celdas = size * size;
+    MatrizDLX m;
+    m.size = size;
+    m.columnas = 4 * celdas;
+    int totalNodos = 1 + m.columnas + 4 * celdas * size;
+    m.izq.resize(totalNodos);
+    m.der.resize(totalNodos);
+    m.arriba.resize(totalNodos);
+    m.abajo.resize(totalNodos);
+    m.columna.resize(totalNodos);
+    m.fila.assign(totalNodos, -1);
+    m.tamano.assign(m.columnas + 1, 0);
+    m.primerNodo.resize(celdas * size);
+
+    for (int c = 0; c <= m.columnas; c++) {
+        m.izq[c] = (c == 0) ? m.columnas : c - 1;
+        m.der[c] = (c == m.columnas) ? 0 : c + 1;
+        m.arriba[c] = m.abajo[c] = c;
+        m.columna[c] = c;
+    }
+
+    int nodo = m.columnas + 1;
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            int b = (row / subSize) * subSize + col / subSize;
+            for (int d = 0; d < size; d++) {
+                int id = (row * size + col) * size + d;
+                // Restricciones: celda, fila-número, columna-número y subcuadrícula-número
+                int cols[4] = {
+                    1 + row * size + col,
+                    1 + celdas + row * size + d,
+                    1 + 2 * celdas + col * size + d,
+                    1 + 3 * celdas + b * size + d
+                };
+                m.primerNodo[id] = nodo;
+                for (int k = 0; k < 4; k++) {
+                    int c = cols[k];
+                    m.columna[nodo] = c;
+                    m.fila[nodo] = id;
+                    m.arriba[nodo] = m.arriba[c];
+                    m.abajo[nodo] = c;
+                    m.abajo[m.arriba[c]] = nodo;
+                    m.arriba[c] = nodo;
+                    m.tamano[c]++;
+                    m.izq[nodo] = (k == 0) ? nodo + 3 : nodo - 1;
+                    m.der[nodo] = (k == 3) ? nodo - 3 : nodo + 1;
+                    nodo++;
+                }
+            }
+        }
+    }
+    return m;
+}
+
+// La matriz vacía de cada dimensión se construye una sola vez; cada hilo la copia cuando
+// cambia de dimensión y entre puzzles restaura solo lo que la búsqueda cambia (restaurarDLX)
+const MatrizDLX& matrizDLXBase(int size) {
+    static std::mutex mtxDLX;
+    static std::unique_ptr<MatrizDLX> matrices[MAX_DIMENSION + 1];
+    std::lock_guard<std::mutex> guard(mtxDLX);
+    if (!matrices[size]) matrices[size].reset(new MatrizDLX(construirMatrizDLX(size)));
+    return *matrices[size];
+}
+
+void cubrirColumna(MatrizDLX& m, int c) {
+    m.der[m.izq[c]] = m.der[c];
+    m.izq[m.der[c]] = m.izq[c];
+    for (int i = m.abajo[c]; i != c; i = m.abajo[i]) {
+        for (int j = m.der[i]; j != i; j = m.der[j]) {
+            m.abajo[m.arriba[j]] = m.abajo[j];
+            m.arriba[m.abajo[j]] = m.arriba[j];
+            m.tamano[m.columna[j]]--;
+        }
+    }
+}
+
+void descubrirColumna(MatrizDLX& m, int c) {
+    for (int i = m.arriba[c]; i != c; i = m.arriba[i]) {
+        for (int j = m.izq[i]; j != i; j = m.izq[j]) {
+            m.tamano[m.columna[j]]++;
+            m.abajo[m.arriba[j]] = j;
+            m.arriba[m.abajo[j]] = j;
+        }
+    }
+    m.der[m.izq[c]] = c;
+    m.izq[m.der[c]] = c;
+}
+
+// Algoritmo X: elige la columna con menos nodos y prueba cada fila que la cubre.
+// Si se pasa un control, lo revisa en cada nodo y abandona si este lo indica.
+bool buscarDLX(MatrizDLX& m, std::vector<int>& solucion, ControlBusqueda* control = nullptr) {
+    if (m.der[0] == 0) return true;
+    if (control && control->revisar(m.nodos)) return false;
+    m.nodos++;
+
+    int c = m.der[0];
+    int minimo = m.tamano[c];
+    for (int j = m.der[c]; j != 0 && minimo > 1; j = m.der[j]) {
+        if (m.tamano[j] < minimo) {
+            minimo = m.tamano[j];
+            c = j;
+        }
+    }
+    if (minimo == 0) return false;
+
+    cubrirColumna(m, c);
+    for (int r = m.abajo[c]; r != c; r = m.abajo[r]) {
+        solucion.push_back(m.fila[r]);
+        for (int j = m.der[r]; j != r; j = m.der[j]) cubrirColumna(m, m.columna[j]);
+        if (buscarDLX(m, solucion, control)) return true;
+        for (int j = m.izq[r]; j != r; j = m.izq[j]) descubrirColumna(m, m.columna[j]);
+        solucion.pop_back();
+    }
+    descubrirColumna(m, c);
+    return false;
+}
+
+// Vuelve m a la matriz vacía. Cubrir y descubrir solo tocan los enlaces verticales, los
+// tamaños y los enlaces horizontales de las cabeceras; los enlaces horizontales de las filas,
+// la columna y la fila de cada nodo no cambian nunca, así que se copia solo lo primero: en el
+// corpus del lote, 1 us por puzzle en 9x9 y 43 en 25x25, contra 3 y 165 de copiar la matriz
+// entera. Deshacer las coberturas sale más caro que las dos (12 y 330 us), porque seguir los
+// enlaces cuesta más que copiar arreglos contiguos.
+void restaurarDLX(MatrizDLX& m, const MatrizDLX& base) {
+    if (m.size != base.size) {
+        m = base;
+        return;
+    }
+    std::copy(base.izq.begin(), base.izq.begin() + base.columnas + 1, m.izq.begin());
+    std::copy(base.der.begin(), base.der.begin() + base.columnas + 1, m.der.begin());
+    m.arriba = base.arriba;
+    m.abajo = base.abajo;
+    m.tamano = base.tamano;
+}
+
+// Resuelve con Dancing Links sobre m, la matriz del hilo, dejando el resultado en board. La
+// matriz se copia entera de la base solo cuando cambia la dimensión; entre puzzles de la misma
+// se restauran los enlaces que la búsqueda anterior pudo cambiar.
+bool solveSudokuDLX(Tablero& board, MatrizDLX& m, std::vector<int>& solucion, std::vector<char>& cubierta,
+    ControlBusqueda* control = nullptr) {
+    int size = board.size;
+    restaurarDLX(m, matrizDLXBase(size));
+    m.nodos = 0;
+    cubierta.assign(m.columnas + 1, 0);
+    solucion.clear();
+
+    // Las pistas se fijan cubriendo las columnas de su fila
+    for (int pos = 0; pos < size * size; pos++) {
+        int num = board.celdas[pos];
+        if (num == 0) continue;
+        if (num > size) return false;
+        int id = pos * size + num - 1;
+        int inicio = m.primerNodo[id];
+        for (int k = 0; k < 4; k++) {
+            if (cubierta[m.columna[inicio + k]]) return false; // Pistas contradictorias
+        }
+        for (int k = 0; k < 4; k++) {
+            cubierta[m.columna[inicio + k]] = 1;
+            cubrirColumna(m, m.columna[inicio + k]);
+        }
+        solucion.push_back(id);
+    }
+
+    if (!buscarDLX(m, solucion, control)) return false;
+    for (int id : solucion) {
+        board.celdas[id / size] = static_cast<uint8_t>(id % size + 1);
+    }
+    return true;
+}
+
+// Desde 36x36 Dancing Links (sin las reglas de subcuadrícula y línea) no termina ni en puzzles
+// que la propagación resuelve sin ramificar; el portafolio, el bench, el lote y el servicio no
+// lo usan en tableros mayores que esto
+const int DIMENSION_MAXIMA_DLX = N25x25;
+
+// Estados de un orden que un hilo recicla entre puzzles
+template <int B>
+struct ArenaOrden {
+    EstadoPropagacion<B> raiz;
+    PilaEstados<B> pila;
+    EstadoBitmask<B> bitmask;
+    EstadoMRV<B> mrv;
+};
+
+// Memoria de trabajo de un hilo que se recicla entre puzzles: los estados de cada orden
+// (creados la primera vez que aparece un tablero de esa dimensión) y la matriz de
+// Dancing Links. Después del primer puzzle de cada tamaño ya no se pide memoria nueva.
+struct ArenaSolver {
+    std::tuple<std::unique_ptr<ArenaOrden<3>>, std::unique_ptr<ArenaOrden<4>>,
+        std::unique_ptr<ArenaOrden<5>>, std::unique_ptr<ArenaOrden<6>>, std::unique_ptr<ArenaOrden<7>>,
+        std::unique_ptr<ArenaOrden<8>>> ordenes;
+    MatrizDLX dlx;
+    std::vector<int> solucionDLX;
+    std::vector<char> cubiertaDLX;
+
+    template <int B>
+    ArenaOrden<B>& para() {
+        auto& arena = std::get<B - 3>(ordenes);
+        if (!arena) arena.reset(new ArenaOrden<B>());
+        return *arena;
+    }
+};
+
+// Ubicación de los hilos. La topología se lee una vez de /sys (en Linux): por cada CPU lógica
+// que el proceso puede usar, su núcleo físico, su paquete y su nodo NUMA. Los hilos se
+// reparten primero de a uno por núcleo físico, llenando un nodo antes de pasar al siguiente,
+// y recién después sobre los hermanos SMT. Así los hilos vecinos comparten nodo siempre que
+// se pueda y los robos de trabajo quedan dentro del socket.
+struct CpuLogica {
+    int id = 0;
+    int nucleo = 0;           // Núcleo físico dentro del paquete
+    int paquete = 0;
+    int nodo = 0;             // Nodo NUMA
+    bool hermanoSMT = false;  // Hay otra CPU lógica antes en el mismo núcleo
+};
+
+struct TopologiaCPU {
+    std::vector<CpuLogica> cpus;   // En el orden de reparto
+    int nucleos = 0;               // Núcleos físicos
+    int nodos = 1;
+};
+
+// Hilos de los motores paralelos (--hilos, --fijar, --sin-smt)
+struct OpcionesHilos {
+    int hilos = 0;         // 0: uno por CPU utilizable
+    bool fijar = false;    // Cada hilo queda fijo en su CPU
+    bool sinSMT = false;   // Una CPU por núcleo físico
+};
+
+OpcionesHilos opcionesHilos;
+
+#ifdef __linux__
+// Lista de /sys con rangos ("0-3,8-11")
+std::vector<int> leerListaSys(const std::string& ruta) {
+    std::vector<int> valores;
+    std::ifstream archivo(ruta);
+    std::string rango;
+    while (std::getline(archivo, rango, ',')) {
+        int desde = 0, hasta = 0;
+        int leidos = std::sscanf(rango.c_str(), "%d-%d", &desde, &hasta);
+        if (leidos < 1) continue;
+        if (leidos == 1) hasta = desde;
+        for (int valor = desde; valor <= hasta; valor++) valores.push_back(valor);
+    }
+    return valores;
+}
+
+int leerEnteroSys(const std::string& ruta, int defecto) {
+    std::ifstream archivo(ruta);
+    int valor;
+    return archivo >> valor ? valor : defecto;
+}
+#endif
+
+TopologiaCPU detectarTopologia() {
+    TopologiaCPU topologia;
+#ifdef __linux__
+    cpu_set_t permitidas;
+    CPU_ZERO(&permitidas);
+    if (sched_getaffinity(0, sizeof permitidas, &permitidas) == 0) {
+        std::map<int, int> nodoDeCpu;
+        for (int nodo : leerListaSys("/sys/devices/system/node/online")) {
+            for (int cpu : leerListaSys("/sys/devices/system/node/node" + std::to_string(nodo) + "/cpulist")) {
+                nodoDeCpu[cpu] = nodo;
+            }
+        }
+        std::map<std::pair<int, int>, int> nucleos;
+        std::map<int, int> nodos;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &permitidas)) continue;
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            CpuLogica logica;
+            logica.id = cpu;
+            logica.paquete = leerEnteroSys(base + "physical_package_id", 0);
+            logica.nucleo = leerEnteroSys(base + "core_id", cpu);
+            auto nodo = nodoDeCpu.find(cpu);
+            logica.nodo = nodo != nodoDeCpu.end() ? nodo->second : 0;
+            logica.hermanoSMT = nucleos[std::make_pair(logica.paquete, logica.nucleo)]++ > 0;
+            nodos[logica.nodo]++;
+            topologia.cpus.push_back(logica);
+        }
+        topologia.nucleos = nucleos.size();
+        topologia.nodos = std::max<int>(1, nodos.size());
+    }
+#endif
+    if (topologia.cpus.empty()) {
+        unsigned int cantidad = std::thread::hardware_concurrency();
+        if (cantidad == 0) cantidad = NUM_HILOS;
+        for (unsigned int cpu = 0; cpu < cantidad; cpu++) {
+            CpuLogica logica;
+            logica.id = logica.nucleo = cpu;
+            topologia.cpus.push_back(logica);
+        }
+        topologia.nucleos = cantidad;
+    }
+    std::stable_sort(topologia.cpus.begin(), topologia.cpus.end(), [](const CpuLogica& a, const CpuLogica& b) {
+        return std::make_tuple(a.hermanoSMT, a.nodo, a.paquete, a.nucleo) < std::make_tuple(b.hermanoSMT, b.nodo, b.paquete, b.nucleo);
+    });
+    return topologia;
+}
+
+// Se detecta la primera vez, antes de que se fije ningún hilo (después el proceso ve una sola CPU)
+const TopologiaCPU& topologiaCPU() {
+    static TopologiaCPU topologia = detectarTopologia();
+    return topologia;
+}
+
+// CPUs sobre las que se reparten los hilos; sin SMT, las primeras del orden son una por núcleo
+int cpusUtilizables() {
+    const TopologiaCPU& topologia = topologiaCPU();
+    return opcionesHilos.sinSMT ? topologia.nucleos : static_cast<int>(topologia.cpus.size());
+}
+
+// Hilos para los motores paralelos: los pedidos con --hilos, o uno por CPU utilizable
+int hilosDisponibles() {
+    return opcionesHilos.hilos > 0 ? opcionesHilos.hilos : cpusUtilizables();
+}
+
+// CPU del hilo i de un grupo; si hay más hilos que CPUs se vuelve a empezar
+const CpuLogica& cpuDeHilo(int indice) {
+    return topologiaCPU().cpus[indice % cpusUtilizables()];
+}
+
+// Nodo NUMA del hilo i; sin fijar los hilos no se sabe dónde corren y se toma el 0
+int nodoDeHilo(int indice) {
+    return opcionesHilos.fijar ? cpuDeHilo(indice).nodo : 0;
+}
+
+// Con --fijar, fija el hilo que llama a la CPU del hilo i. Cada trabajador lo llama al arrancar,
+// antes de pedir memoria: Linux ubica cada página en el nodo del primer hilo que la toca, así que
+// las arenas, las pilas y las tareas de cada hilo quedan en su nodo. Los hilos de OpenMP se
+// reutilizan entre regiones y solo se mueven si les toca otro índice.
+void ubicarHilo(int indice) {
+#ifdef __linux__
+    if (!opcionesHilos.fijar) return;
+    thread_local int ubicado = -1;
+    if (ubicado == indice) return;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpuDeHilo(indice).id, &cpus);
+    if (pthread_setaffinity_np(pthread_self(), sizeof cpus, &cpus) == 0) ubicado = indice;
+#else
+    (void)indice;
+#endif
+}
+
+void imprimirTopologia(std::ostream& os) {
+    const TopologiaCPU& topologia = topologiaCPU();
+    os << "CPUs: " << topologia.cpus.size() << " lógicas, " << topologia.nucleos << " núcleos físicos, "
+        << topologia.nodos << (topologia.nodos == 1 ? " nodo NUMA" : " nodos NUMA") << std::endl;
+    int hilos = hilosDisponibles();
+    os << "Hilos: " << hilos << (opcionesHilos.sinSMT ? ", uno por núcleo" : "");
+    if (opcionesHilos.fijar) {
+        os << ", fijados en las CPUs";
+        for (int i = 0; i < hilos; i++) os << (i == 0 ? " " : ",") << cpuDeHilo(i).id;
+    }
+    os << std::endl;
+}
+
+// Hilos de trabajo de los motores paralelos. Se crean la primera vez que hacen falta y
+// quedan dormidos en una variable de condición entre una búsqueda y la siguiente, así que
+// resolver un puzzle no paga crear ni juntar hilos. El hilo i del pool siempre corre el
+// índice i, de modo que queda fijo en la misma CPU y conserva su memoria de trabajo.
+class PoolHilos {
+public:
+    ~PoolHilos() {
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            terminar = true;
+        }
+        cvInicio.notify_all();
+        for (auto& t : trabajadores) t.join();
+    }
+
+    // Corre tarea(i) para cada i en [0, hilos): el 0 en el hilo que llama y los demás en el
+    // pool; vuelve cuando terminaron todos. Si otro hilo ya está usando el pool (por ejemplo,
+    // dos pedidos del servicio a la vez), esta llamada crea sus propios hilos.
+    void ejecutar(int hilos, const std::function<void(int)>& tarea) {
+        if (hilos <= 1) {
+            tarea(0);
+            return;
+        }
+        std::unique_lock<std::mutex> enUso(mtxUso, std::try_to_lock);
+        if (!enUso) {
+            std::vector<std::thread> propios;
+            for (int i = 1; i < hilos; i++) propios.emplace_back(tarea, i);
+            tarea(0);
+            for (auto& t : propios) t.join();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            while (static_cast<int>(trabajadores.size()) < hilos - 1) {
+                trabajadores.emplace_back(&PoolHilos::trabajador, this, static_cast<int>(trabajadores.size()) + 1, generacion);
+            }
+            actual = &tarea;
+            participantes = hilos;
+            restantes = hilos - 1;
+            generacion++;
+        }
+        cvInicio.notify_all();
+        tarea(0);
+        std::unique_lock<std::mutex> lock(mtx);
+        cvFin.wait(lock, [&] { return restantes == 0; });
+        actual = nullptr;
+    }
+
+private:
+    std::mutex mtxUso;  // Una búsqueda a la vez usa el pool
+    std::mutex mtx;
+    std::condition_variable cvInicio;
+    std::condition_variable cvFin;
+    std::vector<std::thread> trabajadores;
+    const std::function<void(int)>* actual = nullptr;
+    int participantes = 0;
+    int restantes = 0;
+    long long generacion = 0;
+    bool terminar = false;
+
+    void trabajador(int indice, long long vista) {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cvInicio.wait(lock, [&] { return terminar || generacion != vista; });
+            if (terminar) return;
+            vista = generacion;
+            if (indice >= participantes) continue; // Esta búsqueda usa menos hilos
+            const std::function<void(int)>& tarea = *actual;
+            lock.unlock();
+            tarea(indice);
+            lock.lock();
+            if (--restantes == 0) cvFin.notify_one();
+        }
+    }
+};
+
+PoolHilos& poolHilos() {
+    static PoolHilos pool;
+    return pool;
+}
+
+// Subárbol pendiente de la búsqueda paralela; lleva su propia copia del estado
+template <int B>
+struct TareaBusqueda {
+    EstadoPropagacion<B> estado;
+    int profundidad = 0;
+};
+
+const int ESPERAS_ACTIVAS = 64;      // Intentos de robo seguidos antes de dormir
+const int ESPERA_OCIOSO_US = 1000;   // Tope de cada siesta; los avisos despiertan antes
+
+// Cola de un trabajador. El dueño saca del final (lo último que generó, con mejor
+// localidad) y los ladrones del frente, donde quedan los subárboles más grandes.
+template <int B>
+struct ColaTrabajo {
+    std::mutex mtx;
+    std::deque<TareaBusqueda<B>> tareas;
+};
+
+// Búsqueda paralela con un número fijo de hilos, que salen del pool. Los primeros niveles
+// del árbol se reparten como tareas; a partir de profundidadCorte cada tarea se resuelve de
+// forma secuencial. Los hilos sin trabajo roban de las colas de los demás (y si no hay nada
+// que robar duermen hasta que aparezca una tarea o termine la búsqueda) y todos abandonan
+// en cuanto se juntan `limite` soluciones (1 para resolver, más para contarlas) o el control
+// indica parar: todos miran la misma bandera en cada nodo, así que una cancelación llega a
+// todos los hilos en lo que tarda un nodo. Cada hilo lleva sus contadores en su propia línea
+// de caché y se suman al final.
+template <int B>
+struct BuscadorParalelo {
+    int numHilos;
+    int profundidadCorte;
+    long long limite;
+    std::vector<std::unique_ptr<ColaTrabajo<B>>> colas;
+    std::vector<ContadoresHilo> porHilo;
+    ControlBusqueda propio;
+    ControlBusqueda* control;          // El del llamador o el propio; se enciende al llegar al límite
+    std::vector<std::vector<int>> victimas; // Orden de robo de cada hilo: primero los de su nodo NUMA
+    std::atomic<int> pendientes{ 0 };  // Tareas encoladas o en proceso
+    std::atomic<long long> encoladas{ 0 };
+    std::atomic<int> durmiendo{ 0 };
+    std::mutex mtxEspera;
+    std::condition_variable cvTrabajo;
+    std::atomic<long long> soluciones{ 0 };
+    EstadoPropagacion<B> solucion;     // La primera que apareció
+
+    explicit BuscadorParalelo(int hilos, long long limiteSoluciones = 1, ControlBusqueda* externo = nullptr)
+        : numHilos(hilos), limite(limiteSoluciones), control(externo ? externo : &propio) {
+        // Suficientes niveles para tener varias tareas por hilo y poder balancear
+        profundidadCorte = 1;
+        while ((1 << profundidadCorte) < numHilos * 8) profundidadCorte++;
+        for (int i = 0; i < numHilos; i++) colas.emplace_back(new ColaTrabajo<B>());
+        porHilo.resize(numHilos);
+        // Cada uno empieza por el siguiente, como en un anillo, pero cruza de nodo al final
+        victimas.resize(numHilos);
+        for (int i = 0; i < numHilos; i++) {
+            for (int mismoNodo = 1; mismoNodo >= 0; mismoNodo--) {
+                for (int k = 1; k < numHilos; k++) {
+                    int v = (i + k) % numHilos;
+                    if ((nodoDeHilo(v) == nodoDeHilo(i)) == (mismoNodo == 1)) victimas[i].push_back(v);
+                }
+            }
+        }
+    }
+
+    void encolar(int id, TareaBusqueda<B>&& tarea) {
+        pendientes.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> guard(colas[id]->mtx);
+            colas[id]->tareas.push_back(std::move(tarea));
+        }
+        encoladas.fetch_add(1);
+        if (durmiendo.load() > 0) despertar();
+    }
+
+    void despertar() {
+        std::lock_guard<std::mutex> guard(mtxEspera);
+        cvTrabajo.notify_all();
+    }
+
+    // Sin nada que robar: unos reintentos cediendo la CPU y después a dormir hasta que se
+    // encole algo nuevo (vista es el contador de encoladas antes del último intento), se
+    // acabe el trabajo o se pida parar. durmiendo se sube antes de mirar las condiciones y
+    // encolar la lee después de publicar la tarea, así que ningún aviso se pierde.
+    void esperarTrabajo(long long vista, int& intentos) {
+        if (++intentos < ESPERAS_ACTIVAS) {
+            std::this_thread::yield();
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mtxEspera);
+        durmiendo.fetch_add(1);
+        cvTrabajo.wait_for(lock, std::chrono::microseconds(ESPERA_OCIOSO_US), [&] {
+            return encoladas.load() != vista || pendientes.load() == 0 || control->detenido();
+        });
+        durmiendo.fetch_sub(1);
+    }
+
+    bool obtenerTarea(int id, TareaBusqueda<B>& tarea) {
+        {
+            std::lock_guard<std::mutex> guard(colas[id]->mtx);
+            if (!colas[id]->tareas.empty()) {
+                tarea = std::move(colas[id]->tareas.back());
+                colas[id]->tareas.pop_back();
+                return true;
+            }
+        }
+        // Robar a los demás, primero a los del mismo nodo
+        INSTRUMENTAR(auto inicio = std::chrono::steady_clock::now());
+        bool robada = false;
+        for (size_t k = 0; k < victimas[id].size() && !robada; k++) {
+            ColaTrabajo<B>& victima = *colas[victimas[id][k]];
+            std::lock_guard<std::mutex> guard(victima.mtx);
+            if (!victima.tareas.empty()) {
+                tarea = std::move(victima.tareas.front());
+                victima.tareas.pop_front();
+                robada = true;
+            }
+        }
+        INSTRUMENTAR(porHilo[id].stats.roboNs += nanosegundosDesde(inicio));
+        INSTRUMENTAR(porHilo[id].stats.robos += robada);
+        return robada;
+    }
+
+    // Cuenta una solución y guarda la primera. Devuelve false cuando ya no hace falta seguir.
+    bool publicarSolucion(int id, const EstadoPropagacion<B>& estado) {
+        long long total = soluciones.fetch_add(1) + 1;
+        if (total > limite) return false;  // Otro hilo completó el límite primero
+        porHilo[id].soluciones++;
+        if (total == 1) solucion = estado;  // Solo un hilo ve el 1; los demás no la tocan
+        if (total == limite) control->parar(EstadoResolucion::Resuelto);
+        return total < limite;
+    }
+
+    void procesar(int id, TareaBusqueda<B>& tarea, PilaEstados<B>& pila) {
+        EstadisticasPropagacion& stats = porHilo[id].stats;
+        if (tarea.profundidad >= profundidadCorte) {
+            // La pila se indexa desde la profundidad de la tarea para que la instrumentación
+            // vea la profundidad real; los niveles de arriba quedan sin usar
+            auto alEncontrar = [&](const EstadoPropagacion<B>& estado) { return publicarSolucion(id, estado); };
+            enumerarSoluciones(tarea.estado, pila, stats, alEncontrar, control, tarea.profundidad);
+            return;
+        }
+
+        if (control->revisar(stats.nodos)) {
+            control->guardarParcial(tarea.estado);
+            return;
+        }
+        stats.nodos++;
+        INSTRUMENTAR(registrarNodo(stats, tarea.profundidad));
+        if (!propagar(tarea.estado, stats)) {
+            INSTRUMENTAR(registrarRetroceso(stats, tarea.profundidad));
+            return;
+        }
+        if (tarea.estado.vacias == 0) {
+            INSTRUMENTAR(trazar(tarea.profundidad, -1, 0, 's'));
+            publicarSolucion(id, tarea.estado);
+            return;
+        }
+        int mejor = celdaMasRestringida(tarea.estado);
+        INSTRUMENTAR(trazar(tarea.profundidad, mejor, contarBits(tarea.estado.candidatos[mejor]), 'r'));
+
+        // Encolar los hijos en orden inverso para que el dueño pruebe primero el número menor
+        typename Topologia<B>::Mascara candidatos = tarea.estado.candidatos[mejor];
+        int nums[Topologia<B>::size];
+        int cantidad = 0;
+        while (candidatos) {
+            nums[cantidad++] = bitMasBajo(candidatos) + 1;
+            candidatos &= candidatos - 1;
+        }
+        for (int k = cantidad - 1; k >= 0; k--) {
+            TareaBusqueda<B> hijo;
+            hijo.estado = tarea.estado;
+            hijo.profundidad = tarea.profundidad + 1;
+            stats.ramificaciones++;
+            INSTRUMENTAR(registrarHipotesis(stats, tarea.profundidad));
+            if (asignar(hijo.estado, mejor, nums[k])) {
+                encolar(id, std::move(hijo));
+            }
+            else {
+                INSTRUMENTAR(registrarRetroceso(stats, hijo.profundidad));
+            }
+        }
+    }
+
+    void trabajador(int id) {
+        ubicarHilo(id);
+        // La tarea en curso y la pila de estados son del hilo y duran lo que él: los del pool
+        // las reutilizan en cada búsqueda, ya ubicadas en su nodo
+        thread_local std::unique_ptr<TareaBusqueda<B>> tarea(new TareaBusqueda<B>());
+        thread_local PilaEstados<B> pila;
+        INSTRUMENTAR(EstadisticasPropagacion& stats = porHilo[id].stats);
+        int intentos = 0;
+        while (!control->detenido()) {
+            long long vista = encoladas.load();
+            if (obtenerTarea(id, *tarea)) {
+                intentos = 0;
+                INSTRUMENTAR(auto inicio = std::chrono::steady_clock::now());
+                procesar(id, *tarea, pila);
+                INSTRUMENTAR(stats.ocupadoNs += nanosegundosDesde(inicio));
+                // La última tarea, o una parada, tiene que despertar a los que duermen
+                if (pendientes.fetch_sub(1) == 1 || control->detenido()) despertar();
+            }
+            else if (pendientes.load() == 0) {
+                break; // No queda trabajo en ninguna cola: el árbol se recorrió completo
+            }
+            else {
+                INSTRUMENTAR(auto inicio = std::chrono::steady_clock::now());
+                esperarTrabajo(vista, intentos);
+                INSTRUMENTAR(stats.ociosoNs += nanosegundosDesde(inicio));
+            }
+        }
+    }
+
+    bool resolver(EstadoPropagacion<B>& estado) {
+        TareaBusqueda<B> raiz;
+        raiz.estado = estado;
+        encolar(0, std::move(raiz));
+
+        poolHilos().ejecutar(numHilos, [this](int id) { trabajador(id); });
+
+        if (totalSoluciones() == 0) return false;
+        estado = solucion;
+        return true;
+    }
+
+    // Suma de los contadores de cada hilo, que nunca pasa del límite
+    long long totalSoluciones() const {
+        long long total = 0;
+        for (const ContadoresHilo& contadores : porHilo) total += contadores.soluciones;
+        return total;
+    }
+};
+
+// Algoritmo de búsqueda paralela sobre el tablero (con hilos <= 0 se usan todos)
+template <int B>
+bool solveSudokup(Tablero& board, ArenaOrden<B>& arena, EstadisticasPropagacion* estadisticas = nullptr, int hilos = 0) {
+    if (!inicializarEstado(arena.raiz, board)) return false;
+
+    if (hilos <= 0) hilos = hilosDisponibles();
+    std::unique_ptr<BuscadorParalelo<B>> buscador(new BuscadorParalelo<B>(hilos));
+    bool resuelto = buscador->resolver(arena.raiz);
+    if (estadisticas) {
+        *estadisticas = EstadisticasPropagacion();
+        for (const ContadoresHilo& contadores : buscador->porHilo) sumarEstadisticas(*estadisticas, contadores.stats);
+    }
+    if (!resuelto) return false;
+    std::memcpy(board.celdas, arena.raiz.celdas, Topologia<B>::total);
+    return true;
+}
+
+// Cuenta las soluciones del tablero hasta `limite`; con más de un hilo los subárboles se
+// reparten entre ellos. Si hay alguna, board queda con la primera encontrada.
+template <int B>
+long long contarSoluciones(Tablero& board, long long limite, ArenaOrden<B>& arena, int hilos,
+    EstadisticasPropagacion* estadisticas) {
+    if (!inicializarEstado(arena.raiz, board)) return 0;
+
+    long long total = 0;
+    EstadisticasPropagacion stats;
+    if (hilos <= 1) {
+        auto alEncontrar = [&](const EstadoPropagacion<B>& estado) {
+            if (total++ == 0) std::memcpy(board.celdas, estado.celdas, Topologia<B>::total);
+            return total < limite;
+        };
+        enumerarSoluciones(arena.raiz, arena.pila, stats, alEncontrar);
+    }
+    else {
+        std::unique_ptr<BuscadorParalelo<B>> buscador(new BuscadorParalelo<B>(hilos, limite));
+        if (buscador->resolver(arena.raiz)) std::memcpy(board.celdas, arena.raiz.celdas, Topologia<B>::total);
+        total = buscador->totalSoluciones();
+        for (const ContadoresHilo& contadores : buscador->porHilo) sumarEstadisticas(stats, contadores.stats);
+    }
+    if (estadisticas) *estadisticas = stats;
+    return total;
+}
+
+// Cuenta las soluciones hasta `limite` (2 alcanza para saber si el puzzle es único).
+// Devuelve 0 si no hay ninguna o la dimensión no es válida.
+long long contarSoluciones(Tablero& board, long long limite, ArenaSolver& arena, int hilos = 1,
+    EstadisticasPropagacion* estadisticas = nullptr) {
+    long long total = 0;
+    despacharOrden(board.size, [&](auto orden) {
+        constexpr int B = decltype(orden)::value;
+        total = contarSoluciones<B>(board, limite, arena.para<B>(), hilos, estadisticas);
+        return true;
+    });
+    return total;
+}
+
+// El puzzle tiene exactamente una solución
+bool tieneSolucionUnica(Tablero& board, ArenaSolver& arena, int hilos = 1) {
+    return contarSoluciones(board, 2, arena, hilos) == 1;
+}
+
+// Estrategias que compiten en el portafolio
+enum class Estrategia : char { Propagacion, Luby, DLX, MRV };
+const int NUM_ESTRATEGIAS = 4;
+const long long UNIDAD_LUBY = 100; // Nodos de la corrida más corta de la serie de reinicios
+
+const char* nombreEstrategia(Estrategia estrategia) {
+    static const char* nombres[NUM_ESTRATEGIAS] = { "propagacion", "luby", "dlx", "mrv" };
+    return nombres[static_cast<int>(estrategia)];
+}
+
+bool estrategiaDesdeNombre(const std::string& nombre, Estrategia& estrategia) {
+    for (int i = 0; i < NUM_ESTRATEGIAS; i++) {
+        if (nombre == nombreEstrategia(static_cast<Estrategia>(i))) {
+            estrategia = static_cast<Estrategia>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Estrategias de los primeros hilos del portafolio, en orden (se cambia con --estrategias).
+// Los hilos que sobran corren Luby, cada uno con su semilla.
+std::vector<Estrategia> mezclaPortafolio = { Estrategia::Propagacion, Estrategia::Luby, Estrategia::DLX, Estrategia::MRV };
+
+// Término i (desde 1) de la serie de Luby: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+long long terminoLuby(long long i) {
+    while (true) {
+        int k = 1;
+        while ((1LL << k) - 1 < i) k++;
+        if ((1LL << k) - 1 == i) return 1LL << (k - 1);
+        i -= (1LL << (k - 1)) - 1;
+    }
+}
+
+// Celda con menos candidatos como celdaMasRestringida, pero los empates se rompen al azar
+// para que cada reinicio entre al árbol por otro lado
+template <int B>
+int celdaMasRestringidaAleatoria(const EstadoPropagacion<B>& estado, std::mt19937_64& rng) {
+    int mejor = -1;
+    int minimo = Topologia<B>::size + 1;
+    int empates = 0;
+    for (int pos = 0; pos < Topologia<B>::total; pos++) {
+        if (estado.celdas[pos] != 0) continue;
+        int c = contarBits(estado.candidatos[pos]);
+        if (c < minimo) {
+            minimo = c;
+            mejor = pos;
+            empates = 1;
+        }
+        else if (c == minimo && rng() % ++empates == 0) {
+            mejor = pos;
+        }
+    }
+    return mejor;
+}
+
+// Como solveSudokuPropagacion, pero prueba los valores de la celda en orden aleatorio y
+// abandona la corrida al gastar `restantes` nodos, encendiendo `cortada`. Si termina sin
+// cortarse y sin solución, recorrió el árbol entero: el puzzle no tiene solución.
+template <int B>
+bool buscarAleatorio(EstadoPropagacion<B>& estado, PilaEstados<B>& pila, EstadisticasPropagacion& stats,
+    std::mt19937_64& rng, long long& restantes, bool& cortada, ControlBusqueda* control, int profundidad = 0) {
+    if (control->revisar(stats.nodos)) {
+        control->guardarParcial(estado);
+        return false;
+    }
+    if (restantes-- <= 0) {
+        cortada = true;
+        return false;
+    }
+    stats.nodos++;
+    INSTRUMENTAR(registrarNodo(stats, profundidad));
+    if (!propagar(estado, stats)) {
+        INSTRUMENTAR(registrarRetroceso(stats, profundidad));
+        return false;
+    }
+    if (estado.vacias == 0) return true;
+
+    int mejor = celdaMasRestringidaAleatoria(estado, rng);
+    int valores[Topologia<B>::size];
+    int cantidad = 0;
+    for (typename Topologia<B>::Mascara c = estado.candidatos[mejor]; c; c &= c - 1) valores[cantidad++] = bitMasBajo(c) + 1;
+    std::shuffle(valores, valores + cantidad, rng);
+
+    EstadoPropagacion<B>& copia = pila.nivel(profundidad);
+    for (int k = 0; k < cantidad; k++) {
+        stats.ramificaciones++;
+        INSTRUMENTAR(registrarHipotesis(stats, profundidad));
+        copia = estado;
+        if (!asignar(copia, mejor, valores[k])) {
+            INSTRUMENTAR(registrarRetroceso(stats, profundidad + 1));
+            continue;
+        }
+        if (buscarAleatorio(copia, pila, stats, rng, restantes, cortada, control, profundidad + 1)) {
+            estado = copia;
+            return true;
+        }
+        if (cortada || control->detenido()) return false;
+    }
+    return false;
+}
+
+// Corridas con órdenes al azar y un límite de nodos que sigue la serie de Luby, así una
+// mala elección temprana no condena toda la búsqueda. Devuelve true con la solución en
+// `trabajo`; false si una corrida terminó sin cortarse (no hay solución) o si el control
+// pidió parar.
+template <int B>
+bool resolverConReinicios(const EstadoPropagacion<B>& raiz, EstadoPropagacion<B>& trabajo, PilaEstados<B>& pila,
+    EstadisticasPropagacion& stats, uint64_t semilla, ControlBusqueda* control, long long& reinicios) {
+    std::mt19937_64 rng(semilla);
+    for (long long i = 1; !control->detenido(); i++) {
+        trabajo = raiz;
+        long long restantes = terminoLuby(i) * UNIDAD_LUBY;
+        bool cortada = false;
+        if (buscarAleatorio(trabajo, pila, stats, rng, restantes, cortada, control)) return true;
+        if (!cortada) return false;
+        reinicios++;
+    }
+    return false;
+}
+
+// Carreras acumuladas del portafolio por estrategia, para ajustar la mezcla a la carga real
+struct EstadisticasPortafolio {
+    std::atomic<long long> carreras{ 0 };
+    std::atomic<long long> reinicios{ 0 };                   // Corridas de Luby cortadas
+    std::atomic<long long> participaciones[NUM_ESTRATEGIAS] = {};
+    std::atomic<long long> victorias[NUM_ESTRATEGIAS] = {};
+    std::atomic<long long> nsVictorias[NUM_ESTRATEGIAS] = {}; // Duración de las carreras que ganó
+};
+
+EstadisticasPortafolio estadisticasPortafolio;
+
+void imprimirEstadisticasPortafolio(const EstadisticasPortafolio& e, std::ostream& os) {
+    long long carreras = e.carreras.load();
+    os << "Portafolio: " << carreras << " carreras, " << e.reinicios.load() << " reinicios de Luby" << std::endl;
+    for (int i = 0; i < NUM_ESTRATEGIAS; i++) {
+        long long participaciones = e.participaciones[i].load();
+        if (participaciones == 0) continue;
+        long long victorias = e.victorias[i].load();
+        os << "  " << std::left << std::setw(12) << nombreEstrategia(static_cast<Estrategia>(i)) << std::right
+            << std::setw(8) << participaciones << " hilos" << std::setw(8) << victorias << " victorias ("
+            << std::fixed << std::setprecision(1) << (carreras > 0 ? 100.0 * victorias / carreras : 0) << "%)";
+        if (victorias > 0) os << ", " << std::setprecision(1) << e.nsVictorias[i].load() / 1000.0 / victorias << " us al ganar";
+        os << std::endl;
+    }
+    os << std::defaultfloat;
+}
+
+// Lo que corre un hilo del portafolio
+struct EstrategiaPortafolio {
+    Estrategia tipo;
+    uint64_t semilla;   // Solo para Luby
+};
+
+// Una carrera del portafolio: cada hilo ataca el puzzle entero con su estrategia y el primero
+// que termina, con la solución o con la prueba de que no la hay, enciende el control y los
+// demás abandonan en su próximo nodo. Cada hilo tiene su propia arena.
+template <int B>
+struct CarreraPortafolio {
+    std::vector<EstrategiaPortafolio> estrategias;
+    std::vector<std::unique_ptr<ArenaSolver>> arenas;
+    std::vector<ContadoresHilo> porHilo;
+    std::vector<long long> reinicios;
+    ControlBusqueda propio;
+    ControlBusqueda* control;          // El del llamador o el propio
+    std::atomic<int> ganador{ -1 };
+    Tablero solucion;
+    bool conSolucion = false;         // Lo escribe el ganador; se lee después de juntar los hilos
+
+    CarreraPortafolio(int hilos, ControlBusqueda* externo) : control(externo ? externo : &propio) {
+        uint64_t semilla = 0;
+        for (int i = 0; i < hilos; i++) {
+            Estrategia tipo = i < static_cast<int>(mezclaPortafolio.size()) ? mezclaPortafolio[i] : Estrategia::Luby;
+            // Sin propagación no terminan en tableros grandes (ver ejecutarBench)
+            if ((tipo == Estrategia::DLX && Topologia<B>::size > DIMENSION_MAXIMA_DLX) ||
+                (tipo == Estrategia::MRV && Topologia<B>::size > N16x16)) {
+                tipo = Estrategia::Luby;
+            }
+            estrategias.push_back({ tipo, tipo == Estrategia::Luby ? ++semilla : 0 });
+            arenas.emplace_back(new ArenaSolver());
+        }
+        porHilo.resize(hilos);
+        reinicios.assign(hilos, 0);
+    }
+
+    void correr(int id, const EstadoPropagacion<B>& raiz, const Tablero& puzzle) {
+        ubicarHilo(id);
+        ArenaSolver& arena = *arenas[id];
+        EstadisticasPropagacion& stats = porHilo[id].stats;
+        Tablero board = puzzle;
+        bool resuelto = false;
+        switch (estrategias[id].tipo) {
+        case Estrategia::Propagacion: {
+            ArenaOrden<B>& estados = arena.para<B>();
+            estados.raiz = raiz;
+            resuelto = solveSudokuPropagacion(estados.raiz, estados.pila, stats, control);
+            if (resuelto) std::memcpy(board.celdas, estados.raiz.celdas, Topologia<B>::total);
+            break;
+        }
+        case Estrategia::Luby: {
+            ArenaOrden<B>& estados = arena.para<B>();
+            resuelto = resolverConReinicios(raiz, estados.raiz, estados.pila, stats, estrategias[id].semilla, control,
+                reinicios[id]);
+            if (resuelto) std::memcpy(board.celdas, estados.raiz.celdas, Topologia<B>::total);
+            break;
+        }
+        case Estrategia::DLX:
+            resuelto = solveSudokuDLX(board, arena.dlx, arena.solucionDLX, arena.cubiertaDLX, control);
+            stats.nodos += arena.dlx.nodos;
+            break;
+        case Estrategia::MRV: {
+            ArenaOrden<B>& estados = arena.para<B>();
+            resuelto = inicializarEstado(estados.mrv, board) && solveSudokuMRV(estados.mrv, 0, control);
+            stats.nodos += estados.mrv.nodos;
+            if (resuelto) copiarEstado(estados.mrv.base, board);
+            break;
+        }
+        }
+
+        // Si terminó sin que lo pararan tiene la respuesta; solo el primero la publica
+        if (!resuelto && control->detenido()) return;
+        int esperado = -1;
+        if (!ganador.compare_exchange_strong(esperado, id)) return;
+        if (resuelto) {
+            solucion = board;
+            conSolucion = true;
+        }
+        control->parar(resuelto ? EstadoResolucion::Resuelto : EstadoResolucion::SinSolucion);
+    }
+
+    EstadoResolucion resolver(const EstadoPropagacion<B>& raiz, const Tablero& puzzle) {
+        poolHilos().ejecutar(estrategias.size(), [&](int id) { correr(id, raiz, puzzle); });
+
+        if (ganador.load() < 0) return control->motivo.load();
+        return conSolucion ? EstadoResolucion::Resuelto : EstadoResolucion::SinSolucion;
+    }
+};
+
+// Resuelve con el portafolio (con hilos <= 0, uno por núcleo). Si se resolvió, board queda con
+// la solución; si no, devuelve la prueba de que no la hay o el motivo del control externo.
+// La carrera se suma a estadisticasPortafolio.
+template <int B>
+EstadoResolucion resolverPortafolio(Tablero& board, int hilos, EstadisticasPropagacion* estadisticas = nullptr,
+    ControlBusqueda* externo = nullptr) {
+    std::unique_ptr<EstadoPropagacion<B>> raiz(new EstadoPropagacion<B>());
+    if (!inicializarEstado(*raiz, board)) return EstadoResolucion::SinSolucion;
+
+    if (hilos <= 0) hilos = hilosDisponibles();
+    auto inicio = std::chrono::steady_clock::now();
+    std::unique_ptr<CarreraPortafolio<B>> carrera(new CarreraPortafolio<B>(hilos, externo));
+    EstadoResolucion estado = carrera->resolver(*raiz, board);
+    double ns = nanosegundosDesde(inicio);
+
+    if (estadisticas) {
+        *estadisticas = EstadisticasPropagacion();
+        for (const ContadoresHilo& contadores : carrera->porHilo) sumarEstadisticas(*estadisticas, contadores.stats);
+    }
+    estadisticasPortafolio.carreras++;
+    for (int i = 0; i < hilos; i++) {
+        int tipo = static_cast<int>(carrera->estrategias[i].tipo);
+        estadisticasPortafolio.participaciones[tipo]++;
+        estadisticasPortafolio.reinicios += carrera->reinicios[i];
+    }
+    int ganador = carrera->ganador.load();
+    if (ganador >= 0) {
+        int tipo = static_cast<int>(carrera->estrategias[ganador].tipo);
+        estadisticasPortafolio.victorias[tipo]++;
+        estadisticasPortafolio.nsVictorias[tipo] += static_cast<long long>(ns);
+    }
+    if (estado == EstadoResolucion::Resuelto) std::memcpy(board.celdas, carrera->solucion.celdas, Topologia<B>::total);
+    return estado;
+}
+
+// Límites de una resolución; los valores en cero no limitan
+struct LimitesResolucion {
+    double plazoSegundos = 0;
+    long long presupuestoNodos = 0;
+    const std::atomic<bool>* cancelar = nullptr; // Token del llamador: al encenderse se abandona
+    int hilos = 1;                               // Más de uno usa la búsqueda paralela
+    bool portafolio = false;                     // Los hilos compiten con estrategias distintas
+    Motor motor = Motor::Propagacion;            // Motor de cada puzzle en lote y en servicio
+
+    bool activos() const { return plazoSegundos > 0 || presupuestoNodos > 0 || cancelar; }
+    // El motor usa varios hilos por puzzle, así que los puzzles van de a uno
+    bool hilosPorPuzzle() const { return portafolio || motor == Motor::Paralelo; }
+    // Motor con el que se resuelve un tablero de esa dimensión: DLX pasa a propagación en los grandes
+    Motor motorPara(int size) const {
+        return motor == Motor::DLX && size > DIMENSION_MAXIMA_DLX ? Motor::Propagacion : motor;
+    }
+};
+
+// Resultado de una resolución con límites. Si no terminó, el tablero es el estado más
+// avanzado que alcanzó la búsqueda (las celdas que fijó la propagación son correctas para
+// ese camino, no necesariamente para la solución).
+struct ResultadoResolucion {
+    EstadoResolucion estado = EstadoResolucion::Invalido;
+    Tablero tablero;
+    EstadisticasPropagacion stats;
+    double segundos = 0;
+};
+
+const char* nombreEstadoResolucion(EstadoResolucion estado) {
+    switch (estado) {
+    case EstadoResolucion::Resuelto: return "resuelto";
+    case EstadoResolucion::SinSolucion: return "sin solución";
+    case EstadoResolucion::PlazoVencido: return "plazo vencido";
+    case EstadoResolucion::PresupuestoAgotado: return "presupuesto agotado";
+    case EstadoResolucion::Cancelado: return "cancelado";
+    case EstadoResolucion::Invalido: return "inválido";
+    }
+    return "";
+}
+
+// Carga los límites en el control y mantiene registrado su plazo mientras vive
+struct GuardaLimites {
+    bool conPlazo = false;
+    VigilantePlazos::Clave clave;
+
+    GuardaLimites(ControlBusqueda& control, const LimitesResolucion& limites) {
+        control.token = limites.cancelar;
+        control.presupuestoNodos = limites.presupuestoNodos;
+        if (limites.plazoSegundos > 0) {
+            auto plazo = VigilantePlazos::Reloj::now() + std::chrono::duration_cast<VigilantePlazos::Reloj::duration>(
+                std::chrono::duration<double>(limites.plazoSegundos));
+            clave = vigilantePlazos().registrar(plazo, &control);
+            conPlazo = true;
+        }
+    }
+
+    ~GuardaLimites() {
+        if (conPlazo) vigilantePlazos().retirar(clave);
+    }
+};
+
+// Resuelve respetando los límites. Siempre devuelve un resultado: la solución, la prueba de
+// que no hay ninguna, o el motivo por el que se abandonó junto con el avance logrado.
+template <int B>
+void resolverConLimites(const Tablero& puzzle, const LimitesResolucion& limites, ArenaOrden<B>& arena,
+    ResultadoResolucion& resultado) {
+    auto inicio = std::chrono::steady_clock::now();
+    resultado.tablero = puzzle;
+    resultado.stats = EstadisticasPropagacion();
+    ControlBusqueda control;
+    bool resuelto = false;
+    {
+        GuardaLimites guarda(control, limites);
+        if (inicializarEstado(arena.raiz, puzzle)) {
+            if (limites.portafolio) {
+                resuelto = resolverPortafolio<B>(resultado.tablero, limites.hilos, &resultado.stats, &control)
+                    == EstadoResolucion::Resuelto;
+                if (resuelto) std::memcpy(arena.raiz.celdas, resultado.tablero.celdas, Topologia<B>::total);
+            }
+            else if (limites.hilos <= 1) {
+                resuelto = solveSudokuPropagacion(arena.raiz, arena.pila, resultado.stats, &control);
+            }
+            else {
+                std::unique_ptr<BuscadorParalelo<B>> buscador(new BuscadorParalelo<B>(limites.hilos, 1, &control));
+                resuelto = buscador->resolver(arena.raiz);
+                for (const ContadoresHilo& contadores : buscador->porHilo) {
+                    sumarEstadisticas(resultado.stats, contadores.stats);
+                }
+            }
+        }
+    }
+
+    if (resuelto) {
+        resultado.estado = EstadoResolucion::Resuelto;
+        std::memcpy(resultado.tablero.celdas, arena.raiz.celdas, Topologia<B>::total);
+    }
+    else if (control.detenido()) {
+        resultado.estado = control.motivo.load();
+        if (control.vaciasParcial <= Topologia<B>::total) resultado.tablero = control.parcial;
+    }
+    else {
+        resultado.estado = EstadoResolucion::SinSolucion;
+    }
+    resultado.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+ResultadoResolucion resolverConLimites(const Tablero& puzzle, const LimitesResolucion& limites, ArenaSolver& arena) {
+    ResultadoResolucion resultado;
+    resultado.tablero = puzzle;
+    despacharOrden(puzzle.size, [&](auto orden) {
+        constexpr int B = decltype(orden)::value;
+        resolverConLimites<B>(puzzle, limites, arena.para<B>(), resultado);
+        return true;
+    });
+    return resultado;
+}
+
+// Resultado compartido por las tareas del modo por filas
+template <int B>
+struct ResultadoFilas {
+    std::atomic<bool> encontrado{ false };
+    EstadoPropagacion<B> solucion;
+    std::vector<ContadoresHilo> porHilo;
+    std::vector<PilaEstados<B>> pilas;
+};
+
+// Fila con vacías que tiene menos celdas por llenar, o -1 si el tablero está completo
+template <int B>
+int siguienteFila(const EstadoPropagacion<B>& estado) {
+    constexpr int size = Topologia<B>::size;
+    int mejor = -1;
+    int minimo = size + 1;
+    for (int row = 0; row < size; row++) {
+        int vacias = 0;
+        for (int col = 0; col < size; col++) {
+            if (estado.celdas[row * size + col] == 0) vacias++;
+        }
+        if (vacias > 0 && vacias < minimo) {
+            minimo = vacias;
+            mejor = row;
+        }
+    }
+    return mejor;
+}
+
+// Llena la fila `fila` de forma especulativa: cada número se prueba sobre una copia del
+// estado que se valida propagando, y si la rama falla la copia se descarta (rollback).
+// Al completar la fila se continúa con la siguiente. Los primeros niveles se reparten
+// como tareas OpenMP, cada una con su propio estado; por debajo del corte las copias
+// salen de la pila del hilo.
+template <int B>
+void resolverFila(EstadoPropagacion<B>& estado, int fila, int profundidad, int profundidadCorte,
+    ResultadoFilas<B>& resultado) {
+    constexpr int size = Topologia<B>::size;
+    if (resultado.encontrado.load(std::memory_order_relaxed)) return;
+    int id = omp_get_thread_num();
+    ubicarHilo(id);
+    EstadisticasPropagacion& stats = resultado.porHilo[id].stats;
+    stats.nodos++;
+    INSTRUMENTAR(registrarNodo(stats, profundidad));
+
+    // Celda de la fila con menos candidatos
+    int pos = -1;
+    int minimo = size + 1;
+    for (int col = 0; col < size; col++) {
+        int p = fila * size + col;
+        if (estado.celdas[p] != 0) continue;
+        int c = contarBits(estado.candidatos[p]);
+        if (c < minimo) {
+            minimo = c;
+            pos = p;
+        }
+    }
+    if (pos < 0) {
+        // Fila completa: pasar a la siguiente o publicar la solución
+        int proxima = siguienteFila(estado);
+        if (proxima >= 0) {
+            resolverFila(estado, proxima, profundidad, profundidadCorte, resultado);
+            return;
+        }
+#pragma omp critical(solucionFilas)
+        {
+            if (!resultado.encontrado.load()) {
+                resultado.solucion = estado;
+                resultado.encontrado.store(true);
+            }
+        }
+        return;
+    }
+
+    typename Topologia<B>::Mascara candidatos = estado.candidatos[pos];
+    while (candidatos && !resultado.encontrado.load(std::memory_order_relaxed)) {
+        int num = bitMasBajo(candidatos) + 1;
+        candidatos &= candidatos - 1;
+        stats.ramificaciones++;
+        INSTRUMENTAR(registrarHipotesis(stats, profundidad));
+        if (profundidad < profundidadCorte) {
+            EstadoPropagacion<B> copia = estado;
+            if (!asignar(copia, pos, num) || !propagar(copia, stats)) {
+                INSTRUMENTAR(registrarRetroceso(stats, profundidad + 1));
+                continue;
+            }
+#pragma omp task firstprivate(copia) shared(resultado)
+            resolverFila(copia, fila, profundidad + 1, profundidadCorte, resultado);
+        }
+        else {
+            EstadoPropagacion<B>& copia = resultado.pilas[id].nivel(profundidad);
+            copia = estado;
+            if (!asignar(copia, pos, num) || !propagar(copia, stats)) {
+                INSTRUMENTAR(registrarRetroceso(stats, profundidad + 1));
+                continue;
+            }
+            resolverFila(copia, fila, profundidad + 1, profundidadCorte, resultado);
+        }
+    }
+}
+
+// Resuelve el tablero en paralelo llenando filas completas de forma especulativa.
+// Cada tarea trabaja sobre su propia copia, así que nunca hay escrituras compartidas
+// en el tablero; la solución se valida antes de publicarse y siempre es consistente.
+template <int B>
+bool resolverSudokuPorFilas(Tablero& board, ArenaOrden<B>& arena, EstadisticasPropagacion* estadisticas, int hilos) {
+    EstadoPropagacion<B>& estado = arena.raiz;
+    std::unique_ptr<ResultadoFilas<B>> resultado(new ResultadoFilas<B>());
+    int numHilos = hilos > 0 ? hilos : hilosDisponibles();
+    resultado->porHilo.resize(numHilos);
+    resultado->pilas.resize(numHilos);
+    if (!inicializarEstado(estado, board) || !propagar(estado, resultado->porHilo[0].stats)) return false;
+
+    int profundidadCorte = 1;
+    while ((1 << profundidadCorte) < numHilos * 8) profundidadCorte++;
+
+    int fila = siguienteFila(estado);
+    if (fila < 0) {
+        resultado->solucion = estado;
+        resultado->encontrado.store(true);
+    }
+    else {
+#pragma omp parallel num_threads(numHilos)
+#pragma omp single
+        resolverFila(estado, fila, 0, profundidadCorte, *resultado);
+    }
+
+    if (estadisticas) {
+        *estadisticas = EstadisticasPropagacion();
+        for (const ContadoresHilo& contadores : resultado->porHilo) sumarEstadisticas(*estadisticas, contadores.stats);
+    }
+    if (!resultado->encontrado.load()) return false;
+    std::memcpy(board.celdas, resultado->solucion.celdas, Topologia<B>::total);
+    return true;
+}
+
+bool resolverSudokuPorFilas(Tablero& board, ArenaSolver& arena, EstadisticasPropagacion* estadisticas = nullptr,
+    int hilos = 0) {
+    return despacharOrden(board.size, [&](auto orden) {
+        constexpr int B = decltype(orden)::value;
+        return resolverSudokuPorFilas<B>(board, arena.para<B>(), estadisticas, hilos);
+    });
+}
+
+// Simetrías del Sudoku: transponer, permutar bandas (grupos de B filas) y pilas (grupos de B
+// columnas), permutar filas dentro de su banda y columnas dentro de su pila, y renombrar los
+// dígitos. Canónico[r][c] = digitos[original[filas[r]][columnas[c]]], leyendo el original
+// transpuesto si hace falta.
+struct TransformacionTablero {
+    bool transpuesta = false;
+    uint8_t filas[MAX_DIMENSION];       // Fila original de cada fila canónica
+    uint8_t columnas[MAX_DIMENSION];    // Columna original de cada columna canónica
+    uint8_t digitos[MAX_DIMENSION + 1]; // Dígito canónico de cada dígito original; el 0 queda 0
+};
+
+inline int celdaOriginal(const TransformacionTablero& t, int size, int row, int col) {
+    int fila = t.filas[row];
+    int columna = t.columnas[col];
+    return t.transpuesta ? columna * size + fila : fila * size + columna;
+}
+
+// Lleva un tablero (el puzzle o su solución) al espacio canónico
+void aplicarTransformacion(const Tablero& original, const TransformacionTablero& t, Tablero& destino) {
+    int size = original.size;
+    destino.size = size;
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            destino.celdas[row * size + col] = t.digitos[original.celdas[celdaOriginal(t, size, row, col)]];
+        }
+    }
+}
+
+// Inversa de aplicarTransformacion: devuelve una solución canónica al espacio del puzzle
+void deshacerTransformacion(const Tablero& canonico, const TransformacionTablero& t, Tablero& destino) {
+    int size = canonico.size;
+    uint8_t inversa[MAX_DIMENSION + 1];
+    for (int d = 0; d <= size; d++) inversa[t.digitos[d]] = static_cast<uint8_t>(d);
+    destino.size = size;
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            destino.celdas[celdaOriginal(t, size, row, col)] = inversa[canonico.celdas[row * size + col]];
+        }
+    }
+}
+
+// Dispersión de 64 bits (el final de splitmix64)
+inline uint64_t dispersarFirma(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Orden de filas (o columnas) según sus firmas: primero los grupos de B por la firma del
+// grupo, después las líneas dentro de cada grupo. Los empates se resuelven por posición.
+void ordenarPorFirma(const uint64_t* firmas, int B, uint8_t* orden) {
+    uint64_t firmasGrupo[MAX_DIMENSION];
+    int grupos[MAX_DIMENSION];
+    for (int g = 0; g < B; g++) {
+        // Una suma de dispersiones no depende del orden de las líneas del grupo
+        firmasGrupo[g] = 0;
+        for (int i = 0; i < B; i++) firmasGrupo[g] += dispersarFirma(firmas[g * B + i]);
+        grupos[g] = g;
+    }
+    std::stable_sort(grupos, grupos + B, [&](int a, int b) { return firmasGrupo[a] < firmasGrupo[b]; });
+    int k = 0;
+    for (int g = 0; g < B; g++) {
+        int lineas[MAX_DIMENSION];
+        for (int i = 0; i < B; i++) lineas[i] = grupos[g] * B + i;
+        std::stable_sort(lineas, lineas + B, [&](int a, int b) { return firmas[a] < firmas[b]; });
+        for (int i = 0; i < B; i++) orden[k++] = static_cast<uint8_t>(lineas[i]);
+    }
+}
+
+// Forma normal del tablero bajo las simetrías, y la transformación que lleva a ella. Las filas
+// y columnas se ordenan por firmas que no cambian al renombrar dígitos ni al permutar las
+// otras líneas (la frecuencia de los dígitos de sus pistas, refinada dos veces con las firmas
+// de las líneas que las cruzan), los dígitos se renombran por orden de aparición, y de las
+// dos orientaciones queda la menor. Dos puzzles equivalentes dan la misma forma salvo que
+// alguna de sus líneas empate en firma con otra; eso solo cuesta aciertos de caché.
+void canonicalizar(const Tablero& board, Tablero& canonico, TransformacionTablero& transformacion) {
+    int size = board.size;
+    int B = static_cast<int>(std::lround(std::sqrt(size)));
+    int frecuencia[MAX_DIMENSION + 1] = {};
+    int16_t filaPista[MAX_CELDAS], columnaPista[MAX_CELDAS];
+    int pistas = 0;
+    for (int pos = 0; pos < size * size; pos++) {
+        if (!board.celdas[pos]) continue;
+        frecuencia[board.celdas[pos]]++;
+        filaPista[pistas] = static_cast<int16_t>(pos / size);
+        columnaPista[pistas] = static_cast<int16_t>(pos % size);
+        pistas++;
+    }
+
+    // Las firmas son sumas sobre las pistas, así que no dependen del orden de las líneas.
+    // Las de la orientación transpuesta son las mismas con filas y columnas intercambiadas.
+    uint64_t firmaFila[MAX_DIMENSION] = {}, firmaColumna[MAX_DIMENSION] = {};
+    for (int k = 0; k < pistas; k++) {
+        int pos = filaPista[k] * size + columnaPista[k];
+        uint64_t h = dispersarFirma(frecuencia[board.celdas[pos]]);
+        firmaFila[filaPista[k]] += h;
+        firmaColumna[columnaPista[k]] += h;
+    }
+    for (int ronda = 0; ronda < 2; ronda++) {
+        uint64_t filas[MAX_DIMENSION] = {}, columnas[MAX_DIMENSION] = {};
+        for (int k = 0; k < pistas; k++) {
+            filas[filaPista[k]] += dispersarFirma(firmaColumna[columnaPista[k]]);
+            columnas[columnaPista[k]] += dispersarFirma(firmaFila[filaPista[k]]);
+        }
+        for (int i = 0; i < size; i++) {
+            firmaFila[i] = dispersarFirma(firmaFila[i] ^ filas[i]);
+            firmaColumna[i] = dispersarFirma(firmaColumna[i] ^ columnas[i]);
+        }
+    }
+
+    Tablero candidato;
+    for (int orientacion = 0; orientacion < 2; orientacion++) {
+        TransformacionTablero t;
+        t.transpuesta = orientacion == 1;
+        ordenarPorFirma(t.transpuesta ? firmaColumna : firmaFila, B, t.filas);
+        ordenarPorFirma(t.transpuesta ? firmaFila : firmaColumna, B, t.columnas);
+
+        // Dígitos por orden de aparición; los que no aparecen van al final en orden
+        std::memset(t.digitos, 0, sizeof(t.digitos));
+        int siguiente = 1;
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                int d = board.celdas[celdaOriginal(t, size, row, col)];
+                if (d && !t.digitos[d]) t.digitos[d] = static_cast<uint8_t>(siguiente++);
+            }
+        }
+        for (int d = 1; d <= size; d++) {
+            if (!t.digitos[d]) t.digitos[d] = static_cast<uint8_t>(siguiente++);
+        }
+
+        aplicarTransformacion(board, t, candidato);
+        if (orientacion == 0 || std::memcmp(candidato.celdas, canonico.celdas, size * size) < 0) {
+            std::memcpy(canonico.celdas, candidato.celdas, size * size);
+            canonico.size = size;
+            transformacion = t;
+        }
+    }
+}
+
+const int FRAGMENTOS_CACHE = 64; // Fragmentos con lock propio; cada pedido bloquea solo el suyo
+
+// Contadores de la caché
+struct EstadisticasCache {
+    long long consultas = 0;
+    long long aciertos = 0;
+    long long inserciones = 0;
+    long long desalojos = 0;
+    long long entradas = 0;
+
+    double tasaAciertos() const { return consultas > 0 ? static_cast<double>(aciertos) / consultas : 0; }
+};
+
+// Caché acotada de puzzle canónico -> solución canónica, repartida en fragmentos por hash
+// con un LRU en cada uno. También recuerda los puzzles sin solución. Los puzzles que se
+// abandonaron por límites no se guardan.
+class CacheSoluciones {
+public:
+    explicit CacheSoluciones(size_t capacidad)
+        : capacidadFragmento(std::max<size_t>(1, (capacidad + FRAGMENTOS_CACHE - 1) / FRAGMENTOS_CACHE)),
+        fragmentos(new Fragmento[FRAGMENTOS_CACHE]) {}
+
+    // Si el puzzle canónico está, deja en solucion la solución canónica (si tiene)
+    bool buscar(const Tablero& canonico, Tablero& solucion, bool& resoluble) {
+        std::string clave = claveDe(canonico);
+        Fragmento& fragmento = fragmentoDe(clave);
+        consultas.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> guard(fragmento.mtx);
+        auto it = fragmento.indice.find(clave);
+        if (it == fragmento.indice.end()) return false;
+        fragmento.lru.splice(fragmento.lru.begin(), fragmento.lru, it->second);
+        const std::string& guardada = it->second->solucion;
+        resoluble = !guardada.empty();
+        if (resoluble) {
+            solucion.size = canonico.size;
+            std::memcpy(solucion.celdas, guardada.data(), guardada.size());
+        }
+        aciertos.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // solucion == nullptr registra que el puzzle no tiene solución
+    void guardar(const Tablero& canonico, const Tablero* solucion) {
+        std::string clave = claveDe(canonico);
+        Fragmento& fragmento = fragmentoDe(clave);
+        std::string valor;
+        if (solucion) valor.assign(reinterpret_cast<const char*>(solucion->celdas), canonico.size * canonico.size);
+        std::lock_guard<std::mutex> guard(fragmento.mtx);
+        if (fragmento.indice.count(clave)) return; // Otro hilo lo resolvió a la vez
+        fragmento.lru.push_front({ clave, std::move(valor) });
+        fragmento.indice.emplace(std::move(clave), fragmento.lru.begin());
+        inserciones.fetch_add(1, std::memory_order_relaxed);
+        if (fragmento.lru.size() > capacidadFragmento) {
+            fragmento.indice.erase(fragmento.lru.back().clave);
+            fragmento.lru.pop_back();
+            desalojos.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    EstadisticasCache estadisticas() {
+        EstadisticasCache e;
+        e.consultas = consultas.load();
+        e.aciertos = aciertos.load();
+        e.inserciones = inserciones.load();
+        e.desalojos = desalojos.load();
+        e.entradas = e.inserciones - e.desalojos;
+        return e;
+    }
+
+private:
+    struct Entrada {
+        std::string clave;
+        std::string solucion; // Vacía: no tiene solución
+    };
+    struct alignas(64) Fragmento {
+        std::mutex mtx;
+        std::list<Entrada> lru; // Lo más reciente al frente
+        std::unordered_map<std::string, std::list<Entrada>::iterator> indice;
+    };
+
+    size_t capacidadFragmento;
+    std::unique_ptr<Fragmento[]> fragmentos;
+    std::atomic<long long> consultas{ 0 };
+    std::atomic<long long> aciertos{ 0 };
+    std::atomic<long long> inserciones{ 0 };
+    std::atomic<long long> desalojos{ 0 };
+
+    static std::string claveDe(const Tablero& board) {
+        std::string clave(1, static_cast<char>(board.size));
+        clave.append(reinterpret_cast<const char*>(board.celdas), board.size * board.size);
+        return clave;
+    }
+
+    Fragmento& fragmentoDe(const std::string& clave) {
+        size_t h = std::hash<std::string>()(clave);
+        return fragmentos[(h >> 16) % FRAGMENTOS_CACHE];
+    }
+};
+
+// Caché del proceso; solo existe si se pidió con --cache
+std::unique_ptr<CacheSoluciones> cacheSoluciones;
+
+// Resuelve pasando antes por la caché. resolver(board) resuelve en su lugar y devuelve
+// Resuelto o SinSolucion, o cualquier otro estado si abandonó (que no se guarda). Lo que
+// se resuelve es el puzzle original, así que sin aciertos el resultado es el mismo que sin caché.
+template <typename F>
+EstadoResolucion resolverConCache(Tablero& board, CacheSoluciones& cache, F&& resolver) {
+    Tablero canonico, solucion;
+    TransformacionTablero transformacion;
+    canonicalizar(board, canonico, transformacion);
+    bool resoluble;
+    if (cache.buscar(canonico, solucion, resoluble)) {
+        if (!resoluble) return EstadoResolucion::SinSolucion;
+        deshacerTransformacion(solucion, transformacion, board);
+        return EstadoResolucion::Resuelto;
+    }
+
+    EstadoResolucion estado = resolver(board);
+    if (estado == EstadoResolucion::Resuelto) {
+        aplicarTransformacion(board, transformacion, solucion);
+        cache.guardar(canonico, &solucion);
+    }
+    else if (estado == EstadoResolucion::SinSolucion) {
+        cache.guardar(canonico, nullptr);
+    }
+    return estado;
+}
+
+void imprimirEstadisticasCache(const EstadisticasCache& e, std::ostream& os) {
+    os << "Caché: " << e.aciertos << " aciertos de " << e.consultas << " consultas (" << std::fixed
+        << std::setprecision(1) << 100.0 * e.tasaAciertos() << "%), " << e.entradas << " entradas, "
+        << e.desalojos << " desalojos" << std::defaultfloat << std::endl;
+}
+
+// Resuelve con el motor elegido usando la instanciación del orden B
+template <int B>
+bool resolverConOrden(Tablero& board, Motor motor, ArenaOrden<B>& arena, EstadisticasPropagacion* estadisticas) {
+    switch (motor) {
+    case Motor::Bitmask:
+        if (!inicializarEstado(arena.bitmask, board) || !solveSudokuBitmask(arena.bitmask, 0)) return false;
+        copiarEstado(arena.bitmask, board);
+        return true;
+    case Motor::MRV:
+        if (!inicializarEstado(arena.mrv, board) || !solveSudokuMRV(arena.mrv, 0)) return false;
+        copiarEstado(arena.mrv.base, board);
+        return true;
+    case Motor::Propagacion: {
+        EstadisticasPropagacion stats;
+        bool resuelto = inicializarEstado(arena.raiz, board) && solveSudokuPropagacion(arena.raiz, arena.pila, stats);
+        if (estadisticas) *estadisticas = stats;
+        if (!resuelto) return false;
+        std::memcpy(board.celdas, arena.raiz.celdas, Topologia<B>::total);
+        return true;
+    }
+    case Motor::Paralelo:
+        return solveSudokup(board, arena, estadisticas);
+    case Motor::Portafolio:
+        return resolverPortafolio<B>(board, 0, estadisticas) == EstadoResolucion::Resuelto;
+    case Motor::Clasico:
+    default: {
+        EstadisticasPropagacion stats;
+        bool resuelto = solveSudoku<B>(board, 0, 0, stats);
+        if (estadisticas) *estadisticas = stats;
+        return resuelto;
+    }
+    }
+}
+
+// Resuelve con el motor elegido dejando la solución en board (que trae las pistas).
+// La dimensión del tablero elige la instanciación; Dancing Links no depende de ella.
+// Con caché, un puzzle equivalente a uno ya resuelto no pasa por el motor.
+bool resolverConMotor(Tablero& board, Motor motor, ArenaSolver& arena, EstadisticasPropagacion* estadisticas = nullptr,
+    CacheSoluciones* cache = nullptr) {
+    if (cache) {
+        if (estadisticas) *estadisticas = EstadisticasPropagacion();
+        return resolverConCache(board, *cache, [&](Tablero& puzzle) {
+            return resolverConMotor(puzzle, motor, arena, estadisticas) ? EstadoResolucion::Resuelto
+                : EstadoResolucion::SinSolucion;
+        }) == EstadoResolucion::Resuelto;
+    }
+    if (motor == Motor::DLX) {
+        if (board.size == 0 || board.size > MAX_DIMENSION) return false;
+        bool resuelto = solveSudokuDLX(board, arena.dlx, arena.solucionDLX, arena.cubiertaDLX);
+        if (estadisticas) {
+            *estadisticas = EstadisticasPropagacion();
+            estadisticas->nodos = arena.dlx.nodos;
+        }
+        return resuelto;
+    }
+    return despacharOrden(board.size, [&](auto orden) {
+        constexpr int B = decltype(orden)::value;
+        return resolverConOrden<B>(board, motor, arena.para<B>(), estadisticas);
+    });
+}
+
+// Duración legible: elige la unidad según la magnitud
+std::string formatearDuracion(double ns) {
+    static const char* unidades[] = { "ns", "us", "ms", "s" };
+    int unidad = 0;
+    while (unidad < 3 && ns >= 1000) {
+        ns /= 1000;
+        unidad++;
+    }
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(unidad == 0 ? 0 : 3) << ns << " " << unidades[unidad];
+    return os.str();
+}
+
+// Función principal para resolver un Sudoku de cualquier tamaño
+// Con preprocesar se propaga hasta el punto fijo antes de entregar el tablero al motor
+void resolverSudoku(const std::vector<std::vector<int>>& initialBoard, Motor motor = Motor::Clasico, bool preprocesar = false) {
+    Tablero board;
+    if (!cargarTablero(initialBoard, board)) {
+        std::cout << "Tablero no válido." << std::endl;
+        return;
+    }
+    std::unique_ptr<ArenaSolver> arena(new ArenaSolver());
+
+    // Imprimir el Sudoku antes de resolverlo
+    std::cout << "Sudoku a resolver:" << std::endl;
+    printBoard(board);
+
+    // Medir solo la resolución, sin la impresión
+    EstadisticasPropagacion estadisticas;
+    auto inicio = std::chrono::steady_clock::now();
+    bool resuelto;
+    if (preprocesar) {
+        resuelto = propagarTablero(board, estadisticas);
+        if (resuelto) {
+            EstadisticasPropagacion delMotor;
+            resuelto = resolverConMotor(board, motor, *arena, &delMotor, cacheSoluciones.get());
+            sumarEstadisticas(estadisticas, delMotor);
+        }
+    }
+    else {
+        resuelto = resolverConMotor(board, motor, *arena, &estadisticas, cacheSoluciones.get());
+    }
+    double ns = nanosegundosDesde(inicio);
+    if (preprocesar || motor == Motor::Propagacion || motor == Motor::Paralelo || motor == Motor::Portafolio) {
+        imprimirEstadisticas(estadisticas);
+    }
+    if (motor == Motor::Portafolio) imprimirEstadisticasPortafolio(estadisticasPortafolio, std::cout);
+    if (cacheSoluciones) imprimirEstadisticasCache(cacheSoluciones->estadisticas(), std::cout);
+
+    if (resuelto) {
+        std::cout << "Sudoku resuelto exitosamente en " << formatearDuracion(ns) << "." << std::endl;
+        printBoard(board);
+    }
+    else {
+        std::cout << "No se pudo resolver el Sudoku (" << formatearDuracion(ns) << ")." << std::endl;
+    }
+}
+
+// Resuelve con la búsqueda paralela; comparte el tablero y la salida con resolverSudoku
+void resolverSudokup(const std::vector<std::vector<int>>& initialBoard) {
+    resolverSudoku(initialBoard, Motor::Paralelo);
+}
+
+// Cuenta las soluciones de un tablero de ejemplo hasta `limite` con todos los hilos
+void contarSudoku(const std::vector<std::vector<int>>& initialBoard, long long limite) {
+    Tablero board;
+    if (!cargarTablero(initialBoard, board)) {
+        std::cout << "Tablero no válido." << std::endl;
+        return;
+    }
+    std::unique_ptr<ArenaSolver> arena(new ArenaSolver());
+    EstadisticasPropagacion estadisticas;
+    auto inicio = std::chrono::steady_clock::now();
+    long long total = contarSoluciones(board, limite, *arena, hilosDisponibles(), &estadisticas);
+    double ns = nanosegundosDesde(inicio);
+
+    if (total == 0) std::cout << "El Sudoku no tiene solución." << std::endl;
+    else if (total == 1 && limite > 1) std::cout << "El Sudoku tiene solución única." << std::endl;
+    else if (total >= limite) std::cout << "El Sudoku tiene al menos " << total << " soluciones." << std::endl;
+    else std::cout << "El Sudoku tiene " << total << " soluciones." << std::endl;
+    imprimirEstadisticas(estadisticas);
+    std::cout << "Tiempo para contar: " << formatearDuracion(ns) << std::endl;
+}
+
+// Resuelve un tablero de ejemplo con plazo, presupuesto de nodos o ambos. Si la búsqueda
+// no termina se muestra hasta dónde llegó.
+void resolverSudokuConLimites(const std::vector<std::vector<int>>& initialBoard, const LimitesResolucion& limites) {
+    Tablero board;
+    if (!cargarTablero(initialBoard, board)) {
+        std::cout << "Tablero no válido." << std::endl;
+        return;
+    }
+    std::unique_ptr<ArenaSolver> arena(new ArenaSolver());
+    std::cout << "Sudoku a resolver:" << std::endl;
+    printBoard(board);
+
+    ResultadoResolucion resultado = resolverConLimites(board, limites, *arena);
+    imprimirEstadisticas(resultado.stats);
+    if (limites.portafolio) imprimirEstadisticasPortafolio(estadisticasPortafolio, std::cout);
+    std::cout << "Estado: " << nombreEstadoResolucion(resultado.estado) << " en "
+        << formatearDuracion(resultado.segundos * 1e9) << "." << std::endl;
+    if (resultado.estado == EstadoResolucion::Resuelto) {
+        printBoard(resultado.tablero);
+    }
+    else if (resultado.estado != EstadoResolucion::SinSolucion) {
+        int vacias = 0;
+        for (int pos = 0; pos < board.size * board.size; pos++) vacias += resultado.tablero.celdas[pos] == 0;
+        std::cout << "Avance al detenerse (" << vacias << " celdas vacías):" << std::endl;
+        printBoard(resultado.tablero);
+    }
+}
+
+
+
+// Formato de línea: un puzzle por línea, '.' o '0' para las vacías, 1-9 y luego A-Z para
+// los números del 10 al 35. Hasta 25x25 las minúsculas valen lo mismo que las mayúsculas;
+// desde 36x36 a-z son del 36 al 61 y '+', '/' y '@' del 62 al 64. La longitud (81, 256,
+// 625, 1296, 2401 o 4096) define la dimensión.
+int valorDesdeCaracter(char c, int size) {
+    if (c == '.' || c == '0') return 0;
+    if (c >= '1' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'z') return size > 35 ? c - 'a' + 36 : c - 'a' + 10;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    if (c == '@') return 64;
+    return -1;
+}
+
+char caracterDesdeValor(int valor) {
+    if (valor == 0) return '.';
+    if (valor <= 9) return static_cast<char>('0' + valor);
+    if (valor <= 35) return static_cast<char>('A' + valor - 10);
+    if (valor <= 61) return static_cast<char>('a' + valor - 36);
+    static const char resto[] = { '+', '/', '@' };
+    return resto[valor - 62];
+}
+
+int dimensionDesdeLongitud(size_t longitud) {
+    switch (longitud) {
+    case 81: return N9x9;
+    case 256: return N16x16;
+    case 625: return N25x25;
+    case 1296: return N36x36;
+    case 2401: return N49x49;
+    case 4096: return N64x64;
+    default: return 0;
+    }
+}
+
+// Resultado de un puzzle del lote
+enum class ResultadoLinea : char { Resuelto, SinSolucion, Invalido, Agotado };
+
+// Línea de la entrada vista directamente sobre el archivo mapeado, sin copiarla
+struct VistaLinea {
+    const char* inicio;
+    int longitud;
+};
+
+// Resuelve con un motor distinto del de propagación, revisando el control si lo hay (MRV, DLX
+// y el paralelo lo revisan; el clásico y el de máscaras no, y con límites main no los admite
+// en lote). Trabaja sobre una copia, así que board solo cambia si quedó resuelto y verificado.
+bool resolverConMotorControlado(Tablero& board, Motor motor, int hilos, ArenaSolver& arena,
+    EstadisticasPropagacion& stats, ControlBusqueda* control) {
+    Tablero trabajo = board;
+    bool resuelto = false;
+    if (motor == Motor::DLX) {
+        resuelto = solveSudokuDLX(trabajo, arena.dlx, arena.solucionDLX, arena.cubiertaDLX, control);
+        stats.nodos += arena.dlx.nodos;
+    }
+    else {
+        despacharOrden(trabajo.size, [&](auto orden) {
+            constexpr int B = decltype(orden)::value;
+            ArenaOrden<B>& estados = arena.para<B>();
+            switch (motor) {
+            case Motor::MRV:
+                resuelto = inicializarEstado(estados.mrv, trabajo) && solveSudokuMRV(estados.mrv, 0, control);
+                stats.nodos += estados.mrv.nodos;
+                if (resuelto) copiarEstado(estados.mrv.base, trabajo);
+                break;
+            case Motor::Paralelo: {
+                if (!inicializarEstado(estados.raiz, trabajo)) break;
+                std::unique_ptr<BuscadorParalelo<B>> buscador(new BuscadorParalelo<B>(hilos, 1, control));
+                resuelto = buscador->resolver(estados.raiz);
+                for (const ContadoresHilo& contadores : buscador->porHilo) sumarEstadisticas(stats, contadores.stats);
+                if (resuelto) std::memcpy(trabajo.celdas, estados.raiz.celdas, Topologia<B>::total);
+                break;
+            }
+            default: {
+                EstadisticasPropagacion delMotor;
+                resuelto = resolverConOrden<B>(trabajo, motor, estados, &delMotor);
+                sumarEstadisticas(stats, delMotor);
+                break;
+            }
+            }
+            return true;
+        });
+    }
+    if (!resuelto || !despacharOrden(trabajo.size, [&](auto orden) { return validarSolucion<decltype(orden)::value>(trabajo.celdas); })) {
+        return false;
+    }
+    board = trabajo;
+    return true;
+}
+
+// Resuelve un puzzle de un lote (board trae las pistas, de dimensión válida) con la arena del
+// hilo, el motor y los límites de cada puzzle. Si se resolvió, board queda con la solución verificada.
+EstadoResolucion resolverTablero(Tablero& board, ArenaSolver& arena, EstadisticasPropagacion& stats,
+    const LimitesResolucion& limites, CacheSoluciones* cache = nullptr) {
+    int size = board.size;
+    // Sin límites no se paga el control; con ellos cada puzzle lleva el suyo
+    std::unique_ptr<ControlBusqueda> control;
+    std::unique_ptr<GuardaLimites> guarda;
+    if (limites.activos()) {
+        control.reset(new ControlBusqueda());
+        guarda.reset(new GuardaLimites(*control, limites));
+    }
+    auto resolver = [&](Tablero& puzzle) {
+        if (limites.portafolio) {
+            EstadoResolucion estado = EstadoResolucion::SinSolucion;
+            despacharOrden(size, [&](auto orden) {
+                constexpr int B = decltype(orden)::value;
+                EstadisticasPropagacion delPortafolio;
+                estado = resolverPortafolio<B>(puzzle, limites.hilos, &delPortafolio, control.get());
+                sumarEstadisticas(stats, delPortafolio);
+                if (estado == EstadoResolucion::Resuelto && !validarSolucion<B>(puzzle.celdas)) {
+                    estado = EstadoResolucion::SinSolucion;
+                }
+                return true;
+            });
+            return estado;
+        }
+        Motor motor = limites.motorPara(size);
+        if (motor != Motor::Propagacion) {
+            if (resolverConMotorControlado(puzzle, motor, limites.hilos, arena, stats, control.get())) {
+                return EstadoResolucion::Resuelto;
+            }
+            return control && control->detenido() ? control->motivo.load() : EstadoResolucion::SinSolucion;
+        }
+        bool resuelto = despacharOrden(size, [&](auto orden) {
+            constexpr int B = decltype(orden)::value;
+            ArenaOrden<B>& estados = arena.para<B>();
+            // La solución se verifica antes de escribirla
+            if (!inicializarEstado(estados.raiz, puzzle)
+                || !solveSudokuPropagacion(estados.raiz, estados.pila, stats, control.get())
+                || !validarSolucion<B>(estados.raiz.celdas)) {
+                return false;
+            }
+            std::memcpy(puzzle.celdas, estados.raiz.celdas, Topologia<B>::total);
+            return true;
+        });
+        if (resuelto) return EstadoResolucion::Resuelto;
+        return control && control->detenido() ? control->motivo.load() : EstadoResolucion::SinSolucion;
+    };
+    return cache ? resolverConCache(board, *cache, resolver) : resolver(board);
+}
+
+// Resuelve el puzzle leyendo los caracteres en su lugar y escribe la solución en salida
+// (longitud caracteres). Si no hay solución, o se agotaron los límites del puzzle, se copia
+// la línea tal cual, así la salida conserva una línea por puzzle en el orden de entrada.
+ResultadoLinea resolverLinea(VistaLinea linea, char* salida, Tablero& board, ArenaSolver& arena,
+    EstadisticasPropagacion& stats, const LimitesResolucion& limites, CacheSoluciones* cache = nullptr) {
+    std::memcpy(salida, linea.inicio, linea.longitud);
+    int size = dimensionDesdeLongitud(linea.longitud);
+    if (size == 0) return ResultadoLinea::Invalido;
+
+    board.size = size;
+    for (int pos = 0; pos < size * size; pos++) {
+        int num = valorDesdeCaracter(linea.inicio[pos], size);
+        if (num < 0 || num > size) return ResultadoLinea::Invalido;
+        board.celdas[pos] = static_cast<uint8_t>(num);
+    }
+    switch (resolverTablero(board, arena, stats, limites, cache)) {
+    case EstadoResolucion::Resuelto:
+        for (int pos = 0; pos < size * size; pos++) salida[pos] = caracterDesdeValor(board.celdas[pos]);
+        return ResultadoLinea::Resuelto;
+    case EstadoResolucion::SinSolucion:
+        return ResultadoLinea::SinSolucion;
+    default:
+        return ResultadoLinea::Agotado;
+    }
+}
+
+// Archivo de entrada mapeado en memoria. Donde no hay mmap se lee completo una vez.
+struct ArchivoMapeado {
+    const char* datos = nullptr;
+    size_t longitud = 0;
+#ifdef _WIN32
+    std::vector<char> copia;
+#endif
+};
+
+bool mapearArchivo(const std::string& ruta, ArchivoMapeado& archivo) {
+#ifdef _WIN32
+    std::ifstream entrada(ruta, std::ios::binary);
+    if (!entrada) return false;
+    archivo.copia.assign(std::istreambuf_iterator<char>(entrada), std::istreambuf_iterator<char>());
+    archivo.datos = archivo.copia.data();
+    archivo.longitud = archivo.copia.size();
+    return true;
+#else
+    int fd = open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    archivo.longitud = static_cast<size_t>(info.st_size);
+    if (archivo.longitud > 0) {
+        void* datos = mmap(nullptr, archivo.longitud, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (datos == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(datos, archivo.longitud, MADV_SEQUENTIAL);
+        archivo.datos = static_cast<const char*>(datos);
+    }
+    close(fd); // El mapeo sigue siendo válido sin el descriptor
+    return true;
+#endif
+}
+
+void liberarArchivo(ArchivoMapeado& archivo) {
+#ifndef _WIN32
+    if (archivo.datos) munmap(const_cast<char*>(archivo.datos), archivo.longitud);
+#endif
+    archivo.datos = nullptr;
+    archivo.longitud = 0;
+}
+
+// Escribe todo el buffer con llamadas directas a write, reintentando las escrituras parciales
+bool escribirTodo(int fd, const char* datos, size_t longitud) {
+    while (longitud > 0) {
+#ifdef _WIN32
+        int escritos = _write(fd, datos, static_cast<unsigned int>(longitud));
+#else
+        ssize_t escritos = write(fd, datos, longitud);
+#endif
+        if (escritos <= 0) return false;
+        datos += escritos;
+        longitud -= escritos;
+    }
+    return true;
+}
+
+// Abre la salida de un modo por lotes: la ruta pedida, o la salida estándar si está vacía
+int abrirSalida(const std::string& ruta) {
+    if (ruta.empty()) return 1;
+#ifdef _WIN32
+    return _open(ruta.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+    return open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+void cerrarSalida(int fd) {
+    if (fd == 1) return;
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+// Resumen de una corrida por lotes
+struct ReporteLote {
+    long long total = 0;
+    long long resueltos = 0;
+    long long sinSolucion = 0;
+    long long invalidos = 0;
+    long long agotados = 0;  // Abandonados por el plazo o el presupuesto de cada puzzle
+    long long conPropagacion = 0; // Pedidos con DLX pero mayores que DIMENSION_MAXIMA_DLX
+    double segundos = 0;
+    double p50ns = 0;   // Latencia mediana por puzzle
+    double p99ns = 0;
+};
+
+// Percentil p (0..1) de un conjunto de muestras; las reordena
+double percentil(std::vector<double>& muestras, double p) {
+    if (muestras.empty()) return 0;
+    size_t k = static_cast<size_t>(p * (muestras.size() - 1));
+    std::nth_element(muestras.begin(), muestras.begin() + k, muestras.end());
+    return muestras[k];
+}
+
+// Modo por lotes: mapea rutaEntrada en memoria y la recorre por bloques. Los puzzles se
+// leen en su lugar y se reparten entre todos los hilos con planificación dinámica (una arena
+// de solver por hilo, así que tras el primer bloque no se pide memoria por puzzle). Como
+// cada solución mide lo mismo que su línea, cada hilo la escribe directamente en su
+// posición del buffer del bloque, que sale entero con un solo write en el orden de entrada
+// (a rutaSalida, o a la salida estándar si la ruta está vacía).
+// Los límites se aplican a cada puzzle por separado. Con el portafolio o el motor paralelo
+// los puzzles van de a uno y los hilos trabajan dentro de cada puzzle.
+bool resolverLote(const std::string& rutaEntrada, const std::string& rutaSalida, ReporteLote& reporte,
+    const LimitesResolucion& limites = LimitesResolucion(), CacheSoluciones* cache = nullptr) {
+    ArchivoMapeado archivo;
+    if (!mapearArchivo(rutaEntrada, archivo)) return false;
+    int fd = abrirSalida(rutaSalida);
+    if (fd < 0) {
+        liberarArchivo(archivo);
+        return false;
+    }
+
+    int numHilos = limites.hilosPorPuzzle() ? 1 : hilosDisponibles();
+    std::vector<std::unique_ptr<ArenaSolver>> arenas(numHilos);
+    for (auto& arena : arenas) arena.reset(new ArenaSolver());
+    std::vector<Tablero> tableros(numHilos);
+    std::vector<ContadoresHilo> porHilo(numHilos);
+
+    std::vector<VistaLinea> bloque;
+    std::vector<size_t> desplazamientos;
+    std::vector<char> bufferSalida;
+    std::vector<ResultadoLinea> resultados;
+    std::vector<double> latencias;
+    reporte = ReporteLote();
+    bool ok = true;
+    auto inicio = std::chrono::steady_clock::now();
+
+    const char* cursor = archivo.datos;
+    const char* fin = archivo.datos + archivo.longitud;
+    while (ok && cursor < fin) {
+        bloque.clear();
+        while (bloque.size() < static_cast<size_t>(TAMANO_BLOQUE_LOTE) && cursor < fin) {
+            const char* salto = static_cast<const char*>(std::memchr(cursor, '\n', fin - cursor));
+            const char* finLinea = salto ? salto : fin;
+            int longitud = static_cast<int>(finLinea - cursor);
+            if (longitud > 0 && cursor[longitud - 1] == '\r') longitud--;
+            if (longitud > 0 && cursor[0] != '#') bloque.push_back({ cursor, longitud });
+            cursor = salto ? salto + 1 : fin;
+        }
+
+        // Posición de cada solución dentro del buffer del bloque
+        int cantidad = bloque.size();
+        desplazamientos.resize(cantidad + 1);
+        desplazamientos[0] = 0;
+        for (int i = 0; i < cantidad; i++) desplazamientos[i + 1] = desplazamientos[i] + bloque[i].longitud + 1;
+        bufferSalida.resize(desplazamientos[cantidad]);
+
+        size_t base = latencias.size();
+        latencias.resize(base + cantidad);
+        resultados.resize(cantidad);
+#pragma omp parallel for schedule(dynamic, CHUNK_LOTE) num_threads(numHilos)
+        for (int i = 0; i < cantidad; i++) {
+            int id = omp_get_thread_num();
+            ubicarHilo(id);
+            char* salida = &bufferSalida[desplazamientos[i]];
+            auto t0 = std::chrono::steady_clock::now();
+            resultados[i] = resolverLinea(bloque[i], salida, tableros[id], *arenas[id], porHilo[id].stats, limites, cache);
+            latencias[base + i] = nanosegundosDesde(t0);
+            salida[bloque[i].longitud] = '\n';
+        }
+
+        ok = escribirTodo(fd, bufferSalida.data(), bufferSalida.size());
+        for (int i = 0; i < cantidad; i++) {
+            switch (resultados[i]) {
+            case ResultadoLinea::Resuelto: reporte.resueltos++; break;
+            case ResultadoLinea::SinSolucion: reporte.sinSolucion++; break;
+            case ResultadoLinea::Invalido: reporte.invalidos++; break;
+            case ResultadoLinea::Agotado: reporte.agotados++; break;
+            }
+            if (resultados[i] != ResultadoLinea::Invalido
+                && limites.motorPara(dimensionDesdeLongitud(bloque[i].longitud)) != limites.motor) {
+                reporte.conPropagacion++;
+            }
+        }
+        reporte.total += cantidad;
+    }
+
+    reporte.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    reporte.p50ns = percentil(latencias, 0.50);
+    reporte.p99ns = percentil(latencias, 0.99);
+    cerrarSalida(fd);
+    liberarArchivo(archivo);
+    return ok;
+}
+
+void imprimirReporteLote(const ReporteLote& reporte, std::ostream& os) {
+    os << "Lote: " << reporte.total << " puzzles (" << reporte.resueltos << " resueltos, "
+        << reporte.sinSolucion << " sin solución, " << reporte.invalidos << " inválidos";
+    if (reporte.agotados > 0) os << ", " << reporte.agotados << " agotados";
+    os << ") en "
+        << std::fixed << std::setprecision(3) << reporte.segundos << " s" << std::endl;
+    os << "Rendimiento: " << std::setprecision(1)
+        << (reporte.segundos > 0 ? reporte.total / reporte.segundos : 0) << " puzzles/s" << std::endl;
+    os << "Latencia por puzzle: p50 = " << std::setprecision(1) << reporte.p50ns / 1000.0
+        << " us, p99 = " << reporte.p99ns / 1000.0 << " us" << std::endl;
+    if (reporte.conPropagacion > 0) {
+        os << "Nota: " << reporte.conPropagacion << " puzzles mayores que " << DIMENSION_MAXIMA_DLX << "x"
+            << DIMENSION_MAXIMA_DLX << " se resolvieron con propagación (Dancing Links no termina en ellos)" << std::endl;
+    }
+    os << std::defaultfloat;
+}
+
+// Formato binario compacto. El archivo empieza con la firma "SDKB" y sigue con bloques de
+// tableros de una misma dimensión. Cada bloque abre con una cabecera de 8 bytes: dimensión,
+// bits por celda (ceil(log2(N+1)): 4 en 9x9, 5 en 16x16 y 25x25, 6 en 36x36 y 49x49, 7 en
+// 64x64), banderas, un byte reservado y la cantidad de tableros (32 bits, little endian).
+// Cada tablero empaqueta sus celdas fila a fila desde el bit menos significativo, precedidas
+// por un bit de resuelto si el bloque lo lleva, y se completa hasta el byte: un 25x25 ocupa
+// 391 bytes contra los 626 de su línea. Como la cantidad va en cada bloque, el escritor no
+// necesita conocer el total ni volver atrás, y el lector nunca tiene más de un tablero en memoria.
+const char FIRMA_BINARIO[4] = { 'S', 'D', 'K', 'B' };
+const int CABECERA_BLOQUE_BINARIO = 8;
+const uint32_t TABLEROS_BLOQUE_BINARIO = 4096; // Tableros que el escritor junta antes de escribir un bloque
+const uint64_t SEMILLA_PRUEBAS = 20240101;     // Tableros de la autoverificación (--probar)
+const int VARIANTES_PRUEBA_CACHE = 24;         // Variantes de cada puzzle en la prueba de la caché
+const uint8_t BANDERA_RESUELTO_BINARIO = 1;    // Cada tablero del bloque lleva su bit de resuelto
+const size_t BUFFER_ESCRITURA_TEXTO = 1 << 20;  // Bytes que juntan los escritores de texto antes de escribir
+const int TABLEROS_BLOQUE_FLUJO = 1024;         // Tableros que resolverFlujo lee y resuelve por bloque (cada uno mide lo del mayor)
+
+int bitsPorCelda(int size) {
+    int bits = 0;
+    while ((1 << bits) < size + 1) bits++;
+    return bits;
+}
+
+int bytesPorTablero(int size, bool conMarca) {
+    return (size * size * bitsPorCelda(size) + (conMarca ? 1 : 0) + 7) / 8;
+}
+
+// Empaqueta el tablero en bytesPorTablero(size, conMarca) bytes a partir de destino
+void empaquetarTablero(const Tablero& board, bool conMarca, bool resuelto, uint8_t* destino) {
+    int bits = bitsPorCelda(board.size);
+    uint64_t acumulado = 0;
+    int pendientes = 0;
+    if (conMarca) {
+        acumulado = resuelto ? 1 : 0;
+        pendientes = 1;
+    }
+    for (int pos = 0; pos < board.size * board.size; pos++) {
+        acumulado |= static_cast<uint64_t>(board.celdas[pos]) << pendientes;
+        pendientes += bits;
+        while (pendientes >= 8) {
+            *destino++ = static_cast<uint8_t>(acumulado);
+            acumulado >>= 8;
+            pendientes -= 8;
+        }
+    }
+    if (pendientes > 0) *destino = static_cast<uint8_t>(acumulado);
+}
+
+// Inversa de empaquetarTablero; false si alguna celda no cabe en la dimensión
+bool desempaquetarTablero(const uint8_t* origen, int size, bool conMarca, Tablero& board, bool& resuelto) {
+    int bits = bitsPorCelda(size);
+    uint64_t acumulado = 0;
+    int disponibles = 0;
+    auto tomar = [&](int cantidad) {
+        while (disponibles < cantidad) {
+            acumulado |= static_cast<uint64_t>(*origen++) << disponibles;
+            disponibles += 8;
+        }
+        int valor = static_cast<int>(acumulado & ((1u << cantidad) - 1));
+        acumulado >>= cantidad;
+        disponibles -= cantidad;
+        return valor;
+    };
+    resuelto = conMarca && tomar(1) != 0;
+    board.size = size;
+    for (int pos = 0; pos < size * size; pos++) {
+        int valor = tomar(bits);
+        if (valor > size) return false;
+        board.celdas[pos] = static_cast<uint8_t>(valor);
+    }
+    return true;
+}
+
+// Formatos de archivo de tableros
+enum class FormatoTablero : char { Lineas, JSON, Binario };
+
+// El de entrada se reconoce por el contenido: la firma del binario, o una llave o corchete
+// como primer carácter visible en el JSON; lo demás se lee como líneas
+FormatoTablero formatoDeEntrada(const std::string& ruta) {
+    std::ifstream entrada(ruta, std::ios::binary);
+    char firma[sizeof FIRMA_BINARIO];
+    if (entrada.read(firma, sizeof firma) && std::memcmp(firma, FIRMA_BINARIO, sizeof firma) == 0) {
+        return FormatoTablero::Binario;
+    }
+    entrada.clear();
+    entrada.seekg(0);
+    char c;
+    while (entrada.get(c) && std::isspace(static_cast<unsigned char>(c))) {}
+    return entrada && (c == '{' || c == '[') ? FormatoTablero::JSON : FormatoTablero::Lineas;
+}
+
+// El de salida, por la extensión: .sdb binario, .json JSON, y líneas para el resto
+FormatoTablero formatoDeSalida(const std::string& ruta) {
+    auto terminaEn = [&](const char* sufijo) {
+        size_t n = std::strlen(sufijo);
+        return ruta.size() >= n && ruta.compare(ruta.size() - n, n, sufijo) == 0;
+    };
+    if (terminaEn(".sdb")) return FormatoTablero::Binario;
+    if (terminaEn(".json")) return FormatoTablero::JSON;
+    return FormatoTablero::Lineas;
+}
+
+// Los lectores y escritores de tableros comparten la forma: abrir, leer o escribir de a un
+// tablero con su marca de resuelto, y cerrar. Los lectores saltean (y cuentan) los tableros
+// que no son válidos y encienden `error` si el archivo está dañado.
+
+// Formato de línea
+struct LectorLineas {
+    std::ifstream entrada;
+    std::string linea;
+    long long invalidos = 0;
+    bool error = false;
+
+    bool abrir(const std::string& ruta) {
+        entrada.open(ruta, std::ios::binary);
+        return static_cast<bool>(entrada);
+    }
+
+    // La marca de resuelto es la de un tablero completo
+    bool leer(Tablero& board, bool& resuelto) {
+        while (std::getline(entrada, linea)) {
+            if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+            if (linea.empty() || linea[0] == '#') continue;
+            int size = dimensionDesdeLongitud(linea.size());
+            bool valido = size != 0;
+            resuelto = true;
+            for (int pos = 0; valido && pos < size * size; pos++) {
+                int num = valorDesdeCaracter(linea[pos], size);
+                valido = num >= 0 && num <= size;
+                board.celdas[pos] = static_cast<uint8_t>(num);
+                resuelto = resuelto && num != 0;
+            }
+            if (!valido) {
+                invalidos++;
+                continue;
+            }
+            board.size = size;
+            return true;
+        }
+        return false;
+    }
+};
+
+struct EscritorLineas {
+    int fd = -1;
+    std::string buffer;
+    bool ok = true;
+
+    bool abrir(const std::string& ruta, bool) {
+        fd = abrirSalida(ruta);
+        return fd >= 0;
+    }
+
+    bool escribir(const Tablero& board, bool) {
+        for (int pos = 0; pos < board.size * board.size; pos++) buffer.push_back(caracterDesdeValor(board.celdas[pos]));
+        buffer.push_back('\n');
+        if (buffer.size() >= BUFFER_ESCRITURA_TEXTO) vaciar();
+        return ok;
+    }
+
+    void vaciar() {
+        ok = ok && escribirTodo(fd, buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+    bool cerrar() {
+        vaciar();
+        cerrarSalida(fd);
+        return ok;
+    }
+};
+
+// Objetos como los de printBoard, uno tras otro (o dentro de un arreglo). Además de "board"
+// se entiende "resuelto"; el resto de los campos no se admite.
+struct LectorJSON {
+    std::ifstream entrada;
+    std::vector<int> valores;
+    long long invalidos = 0;
+    bool error = false;
+
+    bool abrir(const std::string& ruta) {
+        entrada.open(ruta, std::ios::binary);
+        return static_cast<bool>(entrada);
+    }
+
+    int siguiente() {
+        int c;
+        while ((c = entrada.get()) != EOF && std::isspace(c)) {}
+        return c;
+    }
+
+    bool leerEntero(int primero, int& valor) {
+        if (!std::isdigit(primero)) return false;
+        valor = primero - '0';
+        while (valor <= MAX_DIMENSION && std::isdigit(entrada.peek())) valor = valor * 10 + (entrada.get() - '0');
+        return valor <= MAX_DIMENSION;
+    }
+
+    // [[a, b, ...], ...] dejando las celdas en valores; filas es la cantidad de filas
+    bool leerCeldas(int& filas) {
+        valores.clear();
+        filas = 0;
+        size_t ancho = 0;
+        if (siguiente() != '[') return false;
+        int c = siguiente();
+        while (c == '[') {
+            int valor;
+            size_t inicio = valores.size();
+            c = siguiente();
+            while (c != ']') {
+                if (!leerEntero(c, valor)) return false;
+                valores.push_back(valor);
+                c = siguiente();
+                if (c == ',') c = siguiente();
+                else if (c != ']') return false;
+            }
+            if (filas == 0) ancho = valores.size();
+            else if (valores.size() - inicio != ancho) return false;
+            filas++;
+            c = siguiente();
+            if (c == ',') c = siguiente();
+        }
+        return c == ']';
+    }
+
+    bool leer(Tablero& board, bool& resuelto) {
+        int c;
+        // Entre objetos pueden venir los corchetes y comas de un arreglo
+        while ((c = siguiente()) == '[' || c == ']' || c == ',') {}
+        while (c == '{') {
+            int filas = -1;
+            resuelto = false;
+            c = siguiente();
+            while (c == '"') {
+                std::string clave;
+                std::getline(entrada, clave, '"');
+                if (siguiente() != ':') break;
+                if (clave == "board") {
+                    if (!leerCeldas(filas)) break;
+                }
+                else if (clave == "resuelto") {
+                    std::string palabra;
+                    for (c = siguiente(); std::isalpha(c); c = entrada.get()) palabra.push_back(static_cast<char>(c));
+                    entrada.unget();
+                    if (palabra != "true" && palabra != "false") break;
+                    resuelto = palabra == "true";
+                }
+                else {
+                    break;
+                }
+                c = siguiente();
+                if (c == ',') c = siguiente();
+            }
+            if (c != '}') {
+                error = true;
+                return false;
+            }
+            int size = filas > 0 && static_cast<int>(valores.size()) == filas * filas ? dimensionDesdeLongitud(valores.size()) : 0;
+            bool valido = size != 0;
+            for (int pos = 0; valido && pos < size * size; pos++) {
+                valido = valores[pos] <= size;
+                board.celdas[pos] = static_cast<uint8_t>(valores[pos]);
+            }
+            if (valido) {
+                board.size = size;
+                return true;
+            }
+            invalidos++;
+            while ((c = siguiente()) == ']' || c == ',') {}
+        }
+        error = c != EOF;
+        return false;
+    }
+};
+
+struct EscritorJSON {
+    int fd = -1;
+    bool conMarca = false;
+    std::ostringstream buffer;
+    bool ok = true;
+
+    bool abrir(const std::string& ruta, bool marcas) {
+        conMarca = marcas;
+        fd = abrirSalida(ruta);
+        return fd >= 0;
+    }
+
+    bool escribir(const Tablero& board, bool resuelto) {
+        escribirTableroJSON(board, buffer, conMarca, resuelto);
+        if (static_cast<size_t>(buffer.tellp()) >= BUFFER_ESCRITURA_TEXTO) vaciar();
+        return ok;
+    }
+
+    void vaciar() {
+        std::string texto = buffer.str();
+        ok = ok && escribirTodo(fd, texto.data(), texto.size());
+        buffer.str(std::string());
+    }
+
+    bool cerrar() {
+        vaciar();
+        cerrarSalida(fd);
+        return ok;
+    }
+};
+
+struct LectorBinario {
+    std::ifstream entrada;
+    int size = 0;
+    bool conMarca = false;
+    uint32_t restantes = 0;    // Tableros que faltan del bloque actual
+    std::vector<uint8_t> registro;
+    long long invalidos = 0;   // Siempre 0: un tablero que no decodifica es un archivo dañado
+    bool error = false;
+
+    bool abrir(const std::string& ruta) {
+        entrada.open(ruta, std::ios::binary);
+        char firma[sizeof FIRMA_BINARIO];
+        return entrada.read(firma, sizeof firma) && std::memcmp(firma, FIRMA_BINARIO, sizeof firma) == 0;
+    }
 
+    bool leer(Tablero& board, bool& resuelto) {
+        while (restantes == 0) {
+            uint8_t cabecera[CABECERA_BLOQUE_BINARIO];
+            if (!entrada.read(reinterpret_cast<char*>(cabecera), sizeof cabecera)) {
+                error = entrada.gcount() != 0; // Cabecera cortada
+                return false;
+            }
+            size = cabecera[0];
+            if (dimensionDesdeLongitud(size * size) == 0 || cabecera[1] != bitsPorCelda(size)) {
+                error = true;
+                return false;
+            }
+            conMarca = (cabecera[2] & BANDERA_RESUELTO_BINARIO) != 0;
+            restantes = cabecera[4] | cabecera[5] << 8 | cabecera[6] << 16 | static_cast<uint32_t>(cabecera[7]) << 24;
+            registro.resize(bytesPorTablero(size, conMarca));
+        }
+        if (!entrada.read(reinterpret_cast<char*>(registro.data()), registro.size())
+            || !desempaquetarTablero(registro.data(), size, conMarca, board, resuelto)) {
+            error = true;
+            return false;
+        }
+        restantes--;
+        return true;
+    }
+};
 
+struct EscritorBinario {
+    int fd = -1;
+    bool conMarca = false;
+    int size = 0;
+    uint32_t enBloque = 0;
+    std::vector<uint8_t> bloque;   // Cabecera y tableros del bloque en curso
+    bool ok = true;
 
-// Función auxiliar para verificar si es seguro colocar un número en una celda específica
-bool isSafe(const std::vector<std::vector<int>>& board, int row, int col, int num, int dimension) {
-    for (int x = 0; x < dimension; x++) {
-        if (board[row][x] == num || board[x][col] == num) return false;
+    bool abrir(const std::string& ruta, bool marcas) {
+        conMarca = marcas;
+        fd = abrirSalida(ruta);
+        if (fd < 0) return false;
+        ok = escribirTodo(fd, FIRMA_BINARIO, sizeof FIRMA_BINARIO);
+        return ok;
     }
-    int subSize = std::sqrt(dimension);
-    int startRow = row - row % subSize, startCol = col - col % subSize;
-    for (int i = 0; i < subSize; i++) {
-        for (int j = 0; j < subSize; j++) {
-            if (board[startRow + i][startCol + j] == num) return false;
+
+    bool escribir(const Tablero& board, bool resuelto) {
+        if (enBloque > 0 && (board.size != size || enBloque == TABLEROS_BLOQUE_BINARIO)) vaciar();
+        if (enBloque == 0) {
+            size = board.size;
+            bloque.assign(CABECERA_BLOQUE_BINARIO, 0);
         }
+        size_t inicio = bloque.size();
+        bloque.resize(inicio + bytesPorTablero(size, conMarca));
+        empaquetarTablero(board, conMarca, resuelto, &bloque[inicio]);
+        enBloque++;
+        return ok;
     }
-    return true;
+
+    void vaciar() {
+        if (enBloque == 0) return;
+        bloque[0] = static_cast<uint8_t>(size);
+        bloque[1] = static_cast<uint8_t>(bitsPorCelda(size));
+        bloque[2] = conMarca ? BANDERA_RESUELTO_BINARIO : 0;
+        for (int i = 0; i < 4; i++) bloque[4 + i] = static_cast<uint8_t>(enBloque >> (8 * i));
+        ok = ok && escribirTodo(fd, reinterpret_cast<const char*>(bloque.data()), bloque.size());
+        enBloque = 0;
+    }
+
+    bool cerrar() {
+        vaciar();
+        cerrarSalida(fd);
+        return ok;
+    }
+};
+
+// Abre la entrada con el lector de su formato y se lo pasa a usar
+template <typename F>
+bool conLector(const std::string& ruta, F&& usar) {
+    switch (formatoDeEntrada(ruta)) {
+    case FormatoTablero::Binario: {
+        std::unique_ptr<LectorBinario> lector(new LectorBinario());
+        return lector->abrir(ruta) && usar(*lector);
+    }
+    case FormatoTablero::JSON: {
+        std::unique_ptr<LectorJSON> lector(new LectorJSON());
+        return lector->abrir(ruta) && usar(*lector);
+    }
+    case FormatoTablero::Lineas:
+    default: {
+        std::unique_ptr<LectorLineas> lector(new LectorLineas());
+        return lector->abrir(ruta) && usar(*lector);
+    }
+    }
+}
+
+// Abre la salida (la estándar si la ruta está vacía) con el escritor que pide su extensión
+template <typename F>
+bool conEscritor(const std::string& ruta, bool conMarca, F&& usar) {
+    switch (formatoDeSalida(ruta)) {
+    case FormatoTablero::Binario: {
+        std::unique_ptr<EscritorBinario> escritor(new EscritorBinario());
+        return escritor->abrir(ruta, conMarca) && usar(*escritor);
+    }
+    case FormatoTablero::JSON: {
+        std::unique_ptr<EscritorJSON> escritor(new EscritorJSON());
+        return escritor->abrir(ruta, conMarca) && usar(*escritor);
+    }
+    case FormatoTablero::Lineas:
+    default: {
+        std::unique_ptr<EscritorLineas> escritor(new EscritorLineas());
+        return escritor->abrir(ruta, conMarca) && usar(*escritor);
+    }
+    }
+}
+
+// Resumen de una conversión
+struct ReporteConversion {
+    long long tableros = 0;
+    long long invalidos = 0;
+    double segundos = 0;
+};
+
+// Pasa los tableros de un formato a otro de a uno, así el tamaño del archivo no importa.
+// La marca de resuelto se conserva salvo que la entrada sea de líneas, que no la lleva.
+bool convertirTableros(const std::string& rutaEntrada, const std::string& rutaSalida, ReporteConversion& reporte) {
+    reporte = ReporteConversion();
+    auto inicio = std::chrono::steady_clock::now();
+    bool conMarca = formatoDeEntrada(rutaEntrada) != FormatoTablero::Lineas;
+    bool ok = conLector(rutaEntrada, [&](auto& lector) {
+        return conEscritor(rutaSalida, conMarca, [&](auto& escritor) {
+            std::unique_ptr<Tablero> board(new Tablero());
+            bool resuelto;
+            while (lector.leer(*board, resuelto) && escritor.escribir(*board, resuelto)) reporte.tableros++;
+            reporte.invalidos = lector.invalidos;
+            return escritor.cerrar() && !lector.error;
+        });
+    });
+    reporte.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    return ok;
+}
+
+void imprimirReporteConversion(const ReporteConversion& reporte, std::ostream& os) {
+    os << "Conversión: " << reporte.tableros << " tableros";
+    if (reporte.invalidos > 0) os << " (" << reporte.invalidos << " inválidos omitidos)";
+    os << " en " << std::fixed << std::setprecision(3) << reporte.segundos << " s" << std::endl;
+    os << std::defaultfloat;
 }
 
-// Función para resolver una fila del Sudoku utilizando backtracking
-bool resolverFila(std::vector<std::vector<int>>& board, int fila, int dimension) {
-    for (int col = 0; col < dimension; col++) {
-        if (board[fila][col] == 0) {
-            for (int num = 1; num <= dimension; num++) {
-                if (isSafe(board, fila, col, num, dimension)) {
-                    board[fila][col] = num;
-                    if (resolverFila(board, fila, dimension)) return true;
-                    board[fila][col] = 0;
+// Modo por lotes para cuando la entrada o la salida no son líneas: lee bloques de tableros
+// con el lector del formato, los resuelve en paralelo como resolverLote y los escribe en
+// orden, cada uno con su marca de resuelto (los que no se resolvieron quedan como vinieron).
+// Los tableros inválidos de la entrada se omiten y se cuentan.
+bool resolverFlujo(const std::string& rutaEntrada, const std::string& rutaSalida, ReporteLote& reporte,
+    const LimitesResolucion& limites = LimitesResolucion(), CacheSoluciones* cache = nullptr) {
+    int numHilos = limites.hilosPorPuzzle() ? 1 : hilosDisponibles();
+    std::vector<std::unique_ptr<ArenaSolver>> arenas(numHilos);
+    for (auto& arena : arenas) arena.reset(new ArenaSolver());
+    std::vector<ContadoresHilo> porHilo(numHilos);
+    std::vector<Tablero> tableros(TABLEROS_BLOQUE_FLUJO);
+    std::vector<EstadoResolucion> resultados(TABLEROS_BLOQUE_FLUJO);
+    std::vector<double> latencias;
+    reporte = ReporteLote();
+    auto inicio = std::chrono::steady_clock::now();
+
+    bool ok = conLector(rutaEntrada, [&](auto& lector) {
+        return conEscritor(rutaSalida, true, [&](auto& escritor) {
+            bool escrito = true;
+            bool fin = false;
+            while (escrito && !fin) {
+                int cantidad = 0;
+                bool resuelto;
+                while (cantidad < TABLEROS_BLOQUE_FLUJO && !(fin = !lector.leer(tableros[cantidad], resuelto))) cantidad++;
+
+                size_t base = latencias.size();
+                latencias.resize(base + cantidad);
+#pragma omp parallel for schedule(dynamic, CHUNK_LOTE) num_threads(numHilos)
+                for (int i = 0; i < cantidad; i++) {
+                    int id = omp_get_thread_num();
+                    ubicarHilo(id);
+                    auto t0 = std::chrono::steady_clock::now();
+                    resultados[i] = resolverTablero(tableros[i], *arenas[id], porHilo[id].stats, limites, cache);
+                    latencias[base + i] = nanosegundosDesde(t0);
+                }
+
+                for (int i = 0; i < cantidad && escrito; i++) {
+                    // resolverTablero solo toca el tablero si lo resolvió
+                    escrito = escritor.escribir(tableros[i], resultados[i] == EstadoResolucion::Resuelto);
+                    switch (resultados[i]) {
+                    case EstadoResolucion::Resuelto: reporte.resueltos++; break;
+                    case EstadoResolucion::SinSolucion: reporte.sinSolucion++; break;
+                    default: reporte.agotados++; break;
+                    }
+                    if (limites.motorPara(tableros[i].size) != limites.motor) reporte.conPropagacion++;
                 }
+                reporte.total += cantidad;
             }
-            return false;
+            reporte.invalidos = lector.invalidos;
+            reporte.total += lector.invalidos;
+            return escritor.cerrar() && escrito && !lector.error;
+        });
+    });
+
+    reporte.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    reporte.p50ns = percentil(latencias, 0.50);
+    reporte.p99ns = percentil(latencias, 0.99);
+    return ok;
+}
+
+// Sesión interactiva: un tablero que el usuario va editando de a una celda. En lugar de
+// cargar y resolver el tablero entero en cada jugada, la sesión lleva cuántas veces aparece
+// cada número en cada unidad (de ahí salen en O(1) los candidatos de una celda y las
+// repeticiones) y guarda hasta dos soluciones del tablero. Una edición solo descarta las
+// soluciones que contradice, así que las preguntas siguientes casi siempre se contestan con
+// lo guardado y la búsqueda solo corre cuando lo guardado ya no alcanza.
+enum class TecnicaPista : char { Unico, Oculto, Bloqueados, Busqueda };
+
+const char* nombreTecnicaPista(TecnicaPista tecnica) {
+    static const char* nombres[] = { "unico", "oculto", "bloqueados", "busqueda" };
+    return nombres[static_cast<int>(tecnica)];
+}
+
+// Siguiente paso para el usuario: poner num en (row, col), ambos desde 0
+struct PistaSesion {
+    int row = -1;
+    int col = -1;
+    int num = 0;
+    TecnicaPista tecnica = TecnicaPista::Unico;
+};
+
+struct EstadisticasSesion {
+    long long ediciones = 0;
+    long long consultas = 0;     // resoluble, única, solución y pistas
+    long long reutilizadas = 0;  // Consultas contestadas con las soluciones guardadas
+    long long busquedas = 0;     // Consultas que tuvieron que buscar
+};
+
+// Celda vacía con un solo candidato o número con un solo lugar en una unidad, sin asignarlo
+template <int B>
+bool buscarSingle(const EstadoPropagacion<B>& estado, int& pos, int& num, TecnicaPista& tecnica) {
+    using T = Topologia<B>;
+    using Mascara = typename T::Mascara;
+    for (int p = 0; p < T::total; p++) {
+        if (estado.celdas[p] == 0 && contarBits(estado.candidatos[p]) == 1) {
+            pos = p;
+            num = bitMasBajo(estado.candidatos[p]) + 1;
+            tecnica = TecnicaPista::Unico;
+            return true;
         }
     }
-    return true;
+    for (int u = 0; u < 3 * T::size; u++) {
+        const int16_t* celdas = tablasTopologia<B>.unidades[u];
+        Mascara unaVez = 0, variasVeces = 0, colocados = 0;
+        for (int k = 0; k < T::size; k++) {
+            Mascara c = estado.candidatos[celdas[k]];
+            if (estado.celdas[celdas[k]] != 0) {
+                colocados |= c;
+            }
+            else {
+                variasVeces |= unaVez & c;
+                unaVez |= c;
+            }
+        }
+        Mascara unicos = unaVez & ~variasVeces & ~colocados;
+        if (!unicos) continue;
+        num = bitMasBajo(unicos) + 1;
+        for (int k = 0; k < T::size; k++) {
+            if (estado.celdas[celdas[k]] == 0 && (estado.candidatos[celdas[k]] >> (num - 1) & 1)) {
+                pos = celdas[k];
+                break;
+            }
+        }
+        tecnica = TecnicaPista::Oculto;
+        return true;
+    }
+    return false;
 }
 
-// Función que los hilos ejecutarán para resolver filas de manera aleatoria
-void resolverSudokuPorFilasAleatorias(std::vector<std::vector<int>>& board) {
-    int dimension = board.size();
-    std::vector<bool> filasResueltas(dimension, false);
-    std::srand(std::time(0));
+class SesionSudoku {
+public:
+    // Empieza una sesión nueva sobre el tablero; false si la dimensión o algún valor no son válidos.
+    // Las pistas repetidas se aceptan y se cuentan como conflictos, igual que una jugada errónea.
+    bool cargar(const Tablero& inicial) {
+        if (!despacharOrden(inicial.size, [](auto) { return true; })) return false;
+        for (int pos = 0; pos < inicial.size * inicial.size; pos++) {
+            if (inicial.celdas[pos] > inicial.size) return false;
+        }
+        actual.size = inicial.size;
+        subSize = 1;
+        while (subSize * subSize < inicial.size) subSize++;
+        std::memset(actual.celdas, 0, inicial.size * inicial.size);
+        ocurrencias.assign(3 * inicial.size * inicial.size, 0);
+        presentes.assign(3 * inicial.size, 0);
+        repetidos = 0;
+        conocidas = 0;
+        completas = false;
+        for (int pos = 0; pos < inicial.size * inicial.size; pos++) {
+            if (inicial.celdas[pos] != 0) anotar(pos, inicial.celdas[pos], +1);
+        }
+        return true;
+    }
+
+    int dimension() const { return actual.size; }
+    const Tablero& tablero() const { return actual; }
 
-#pragma omp parallel num_threads(8)
-    {
-        bool progreso = true;
-        while (progreso) {
-            progreso = false;
-            int fila;
+    // Pone num en la celda (0 la borra); false si la celda o el número están fuera de rango
+    bool colocar(int row, int col, int num) {
+        int size = actual.size;
+        if (row < 0 || row >= size || col < 0 || col >= size || num < 0 || num > size) return false;
+        int pos = row * size + col;
+        int anterior = actual.celdas[pos];
+        if (anterior == num) return true;
+        estadisticas_.ediciones++;
+        if (anterior != 0) {
+            anotar(pos, anterior, -1);
+            // Con una restricción menos las soluciones guardadas siguen valiendo, pero puede haber otras
+            completas = false;
+        }
+        if (num != 0) {
+            anotar(pos, num, +1);
+            // Con una restricción más solo sobreviven las soluciones que ya tenían ese número ahí;
+            // si se conocían todas, las que quedan también son todas
+            int quedan = 0;
+            for (int k = 0; k < conocidas; k++) {
+                if (soluciones[k].celdas[pos] != num) continue;
+                if (quedan != k) std::memcpy(soluciones[quedan].celdas, soluciones[k].celdas, size * size);
+                quedan++;
+            }
+            conocidas = quedan;
+        }
+        return true;
+    }
+
+    bool borrar(int row, int col) { return colocar(row, col, 0); }
+
+    // Pares (unidad, número) con el número repetido en la unidad
+    int conflictos() const { return repetidos; }
+
+    // Números que no aparecen en la fila, la columna ni la subcuadrícula de la celda (bit num - 1);
+    // 0 si la celda ya tiene número
+    uint64_t candidatos(int row, int col) const {
+        int size = actual.size;
+        if (row < 0 || row >= size || col < 0 || col >= size || actual.en(row, col) != 0) return 0;
+        int B = subSize;
+        uint64_t completo = ~uint64_t(0) >> (64 - size);
+        return completo & ~(presentes[row] | presentes[size + col] | presentes[2 * size + (row / B) * B + col / B]);
+    }
+
+    bool resoluble() {
+        estadisticas_.consultas++;
+        return conSolucion();
+    }
+
+    bool unica() {
+        estadisticas_.consultas++;
+        if (repetidos > 0) return false;
+        if (conocidas == 2 || completas) {
+            estadisticas_.reutilizadas++;
+            return conocidas == 1;
+        }
+        buscar(2);
+        return conocidas == 1;
+    }
+
+    // Una solución del tablero actual, si tiene
+    const Tablero* solucion() {
+        estadisticas_.consultas++;
+        return conSolucion() ? &soluciones[0] : nullptr;
+    }
+
+    // Siguiente paso lógico: un naked single, un hidden single, o uno de ellos después de
+    // aplicar candidatos bloqueados. Si la lógica no alcanza, el número de una solución en la
+    // celda con menos candidatos. False si el tablero está lleno o no tiene solución (una
+    // deducción sobre un tablero que ya tiene un error no le sirve al usuario).
+    bool pista(PistaSesion& pista) {
+        estadisticas_.consultas++;
+        if (!conSolucion()) return false;
+        int pos = -1, num = 0;
+        TecnicaPista tecnica = TecnicaPista::Unico;
+        despacharOrden(actual.size, [&](auto orden) {
+            constexpr int B = decltype(orden)::value;
+            // El tablero tiene solución, así que no puede haber contradicciones
+            EstadoPropagacion<B>& estado = arena.para<B>().raiz;
+            if (!inicializarEstado(estado, actual) || estado.vacias == 0) return true;
+            bool bloqueados = false;
+            EstadisticasPropagacion stats;
+            while (!buscarSingle(estado, pos, num, tecnica)) {
+                bool cambio = false;
+                candidatosBloqueados(estado, stats, cambio);
+                if (!cambio) {
+                    pos = celdaMasRestringida(estado);
+                    tecnica = TecnicaPista::Busqueda;
+                    return true;
+                }
+                bloqueados = true;
+            }
+            if (bloqueados) tecnica = TecnicaPista::Bloqueados;
+            return true;
+        });
+        if (pos < 0) return false;
+        if (tecnica == TecnicaPista::Busqueda) num = soluciones[0].celdas[pos];
+        pista.row = pos / actual.size;
+        pista.col = pos % actual.size;
+        pista.num = num;
+        pista.tecnica = tecnica;
+        return true;
+    }
+
+    const EstadisticasSesion& estadisticas() const { return estadisticas_; }
+
+private:
+    Tablero actual;
+    Tablero soluciones[2];
+    int conocidas = 0;       // Soluciones guardadas, todas distintas y consistentes con actual
+    bool completas = false;  // Las guardadas son todas las que tiene el tablero
+    int repetidos = 0;
+    int subSize = 0;
+    std::vector<uint8_t> ocurrencias; // [unidad][número - 1]: veces que aparece
+    std::vector<uint64_t> presentes;  // Por unidad, los números que aparecen
+    ArenaSolver arena;
+    EstadisticasSesion estadisticas_;
+
+    // Hay solución, con lo guardado si alcanza o buscando una
+    bool conSolucion() {
+        if (repetidos > 0) return false;
+        if (conocidas > 0 || completas) {
+            estadisticas_.reutilizadas++;
+            return conocidas > 0;
+        }
+        buscar(1);
+        return conocidas > 0;
+    }
 
-#pragma omp critical
-            {
-                do {
-                    fila = std::rand() % dimension;
-                } while (filasResueltas[fila]);
-                filasResueltas[fila] = true;
+    // Suma (+1) o quita (-1) num de la celda en sus tres unidades
+    void anotar(int pos, int num, int delta) {
+        int size = actual.size;
+        int B = subSize;
+        int row = pos / size, col = pos % size;
+        int unidades[3] = { row, size + col, 2 * size + (row / B) * B + col / B };
+        uint64_t bit = uint64_t(1) << (num - 1);
+        for (int u : unidades) {
+            uint8_t& veces = ocurrencias[u * size + num - 1];
+            if (delta > 0) {
+                if (++veces == 2) repetidos++;
+                presentes[u] |= bit;
             }
+            else {
+                if (veces-- == 2) repetidos--;
+                if (veces == 0) presentes[u] &= ~bit;
+            }
+        }
+        actual.celdas[pos] = static_cast<uint8_t>(delta > 0 ? num : 0);
+    }
+
+    // Busca desde cero hasta `limite` soluciones (1 o 2) y las guarda
+    void buscar(int limite) {
+        estadisticas_.busquedas++;
+        conocidas = 0;
+        despacharOrden(actual.size, [&](auto orden) {
+            constexpr int B = decltype(orden)::value;
+            ArenaOrden<B>& estados = arena.para<B>();
+            if (!inicializarEstado(estados.raiz, actual)) return true;
+            auto alEncontrar = [&](const EstadoPropagacion<B>& estado) {
+                soluciones[conocidas].size = actual.size;
+                std::memcpy(soluciones[conocidas].celdas, estado.celdas, Topologia<B>::total);
+                return ++conocidas < limite;
+            };
+            EstadisticasPropagacion stats;
+            enumerarSoluciones(estados.raiz, estados.pila, stats, alEncontrar);
+            return true;
+        });
+        completas = conocidas < limite;
+    }
+};
+
+// Modo sesión: lee comandos de la entrada estándar, uno por línea, y contesta cada uno en una
+// línea (filas y columnas desde 1). Pensado para que un front end lo maneje por una tubería.
+//   tablero <puzzle>     empieza una sesión con el puzzle en el formato de línea
+//   poner <f> <c> <n>    pone n en la celda; borrar <f> <c> la vacía
+//   resoluble | unica    si | no
+//   pista                <f> <c> <n> <técnica>, o "ninguna"
+//   candidatos <f> <c>   los números posibles separados por espacios
+//   mostrar | solucion   el tablero o una solución en el formato de línea
+// Al terminar imprime en la salida de errores la latencia de los comandos y cuántas
+// consultas se contestaron sin buscar.
+void ejecutarSesion(std::istream& entrada, std::ostream& salida) {
+    SesionSudoku sesion;
+    bool cargada = false;
+    std::vector<double> latencias;
+    std::string linea;
+    auto escribirTablero = [&](const Tablero& board) {
+        std::string texto(board.size * board.size, '.');
+        for (size_t pos = 0; pos < texto.size(); pos++) texto[pos] = caracterDesdeValor(board.celdas[pos]);
+        salida << texto << std::endl;
+    };
+    while (std::getline(entrada, linea)) {
+        if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+        std::istringstream comando(linea);
+        std::string nombre;
+        if (!(comando >> nombre)) continue;
+        auto inicio = std::chrono::steady_clock::now();
+        int row = 0, col = 0, num = 0;
 
-            if (resolverFila(board, fila, dimension)) {
-                progreso = true;
-#pragma omp critical
-                filasResueltas[fila] = true;
-                std::cout << "Hilo " << omp_get_thread_num() << " resolvió la fila " << fila << std::endl;
+        if (nombre == "tablero") {
+            std::string puzzle;
+            comando >> puzzle;
+            Tablero board;
+            board.size = dimensionDesdeLongitud(puzzle.size());
+            bool valido = board.size > 0;
+            for (int pos = 0; valido && pos < board.size * board.size; pos++) {
+                int valor = valorDesdeCaracter(puzzle[pos], board.size);
+                valido = valor >= 0 && valor <= board.size;
+                board.celdas[pos] = static_cast<uint8_t>(valor);
+            }
+            cargada = valido && sesion.cargar(board);
+            if (cargada) salida << "ok " << board.size << std::endl;
+            else salida << "error tablero inválido" << std::endl;
+        }
+        else if (!cargada) {
+            salida << "error falta el tablero" << std::endl;
+        }
+        else if (nombre == "poner" || nombre == "borrar") {
+            bool leido = nombre == "poner" ? static_cast<bool>(comando >> row >> col >> num) : static_cast<bool>(comando >> row >> col);
+            if (leido && num != 0 && sesion.colocar(row - 1, col - 1, num)) salida << "ok" << std::endl;
+            else if (leido && nombre == "borrar" && sesion.borrar(row - 1, col - 1)) salida << "ok" << std::endl;
+            else salida << "error celda o número fuera de rango" << std::endl;
+        }
+        else if (nombre == "resoluble") {
+            salida << (sesion.resoluble() ? "si" : "no") << std::endl;
+        }
+        else if (nombre == "unica") {
+            salida << (sesion.unica() ? "si" : "no") << std::endl;
+        }
+        else if (nombre == "pista") {
+            PistaSesion pista;
+            if (sesion.pista(pista)) {
+                salida << pista.row + 1 << " " << pista.col + 1 << " " << pista.num << " " << nombreTecnicaPista(pista.tecnica) << std::endl;
             }
             else {
-#pragma omp critical
-                filasResueltas[fila] = false;
+                salida << "ninguna" << std::endl;
+            }
+        }
+        else if (nombre == "candidatos" && comando >> row >> col) {
+            uint64_t candidatos = sesion.candidatos(row - 1, col - 1);
+            bool primero = true;
+            while (candidatos) {
+                salida << (primero ? "" : " ") << bitMasBajo(candidatos) + 1;
+                candidatos &= candidatos - 1;
+                primero = false;
             }
+            salida << std::endl;
         }
+        else if (nombre == "mostrar") {
+            escribirTablero(sesion.tablero());
+        }
+        else if (nombre == "solucion") {
+            const Tablero* solucion = sesion.solucion();
+            if (solucion) escribirTablero(*solucion);
+            else salida << "ninguna" << std::endl;
+        }
+        else {
+            salida << "error comando desconocido" << std::endl;
+        }
+        latencias.push_back(nanosegundosDesde(inicio));
     }
+
+    const EstadisticasSesion& e = sesion.estadisticas();
+    std::cerr << "Sesión: " << latencias.size() << " comandos, " << e.ediciones << " ediciones, "
+        << e.consultas << " consultas (" << e.reutilizadas << " con las soluciones guardadas, "
+        << e.busquedas << " con búsqueda)" << std::endl;
+    std::cerr << std::fixed << std::setprecision(1) << "Latencia por comando: p50 = " << percentil(latencias, 0.50) / 1000
+        << " us, p99 = " << percentil(latencias, 0.99) / 1000 << " us" << std::defaultfloat << std::endl;
 }
 
-// Función para imprimir el tablero de Sudoku en un formato adecuado
-void printBoard(const std::vector<std::vector<int>>& board) {
-    int size = board.size();
-    int subSize = static_cast<int>(std::sqrt(size)); // Tamaño de cada subcuadrícula
+// Autoverificación (--probar): comprobaciones rápidas de las partes en las que un error no
+// se nota a simple vista, porque devolverían datos plausibles pero equivocados. Los archivos
+// de prueba van al directorio temporal y se borran al terminar.
+std::string rutaTemporal(const std::string& nombre) {
+#ifdef _WIN32
+    const char* base = std::getenv("TEMP");
+    const char* defecto = ".";
+#else
+    const char* base = std::getenv("TMPDIR");
+    const char* defecto = "/tmp";
+#endif
+    static const std::string sufijo = std::to_string(std::random_device()());
+    return std::string(base ? base : defecto) + "/sudoku_probar_" + sufijo + "_" + nombre;
+}
 
-    std::cout << "Tablero de Sudoku resuelto:\n";
-    for (int i = 0; i < size; i++) {
-        if (i % subSize == 0 && i != 0) {
-            std::cout << std::string(size * 3 + subSize - 1, '-') << "\n"; // Línea divisoria
+std::string leerArchivoCompleto(const std::string& ruta) {
+    std::ifstream entrada(ruta, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(entrada), std::istreambuf_iterator<char>());
+}
+
+void escribirArchivoCompleto(const std::string& ruta, const std::string& contenido) {
+    std::ofstream salida(ruta, std::ios::binary | std::ios::trunc);
+    salida.write(contenido.data(), contenido.size());
+}
+
+// Informa una comprobación y devuelve si pasó
+bool informarPrueba(std::ostream& os, const std::string& nombre, bool ok) {
+    os << (ok ? "  ok     " : "  FALLA  ") << nombre << std::endl;
+    return ok;
+}
+
+// Formato binario: ida y vuelta líneas -> .sdb -> líneas con todas las dimensiones mezcladas
+// (celdas al máximo, vacías y al azar), las marcas de resuelto, y archivos cortados o dañados,
+// que se tienen que rechazar en lugar de leerse como otros tableros.
+bool probarFormatoBinario(std::ostream& os) {
+    std::mt19937_64 rng(SEMILLA_PRUEBAS);
+    std::vector<Tablero> tableros;
+    for (int size : { N9x9, N16x16, N25x25, N36x36, N49x49, N64x64 }) {
+        for (int tipo = 0; tipo < 3; tipo++) {
+            tableros.emplace_back();
+            Tablero& board = tableros.back();
+            board.size = size;
+            for (int pos = 0; pos < size * size; pos++) {
+                board.celdas[pos] = static_cast<uint8_t>(tipo == 0 ? size : tipo == 1 ? 0 : rng() % (size + 1));
+            }
         }
-        for (int j = 0; j < size; j++) {
-            if (j % subSize == 0 && j != 0) {
-                std::cout << " | "; // Separador de subcuadrículas
+    }
+    std::vector<bool> marcas(tableros.size());
+    for (size_t i = 0; i < marcas.size(); i++) marcas[i] = i % 2 == 1;
+
+    std::string lineas = rutaTemporal("lineas.txt"), binario = rutaTemporal("tableros.sdb");
+    std::string vuelta = rutaTemporal("vuelta.txt"), marcado = rutaTemporal("marcado.sdb"), danado = rutaTemporal("danado.sdb");
+    bool todo = true;
+
+    bool escrito = conEscritor(lineas, false, [&](auto& escritor) {
+        for (const Tablero& board : tableros) escritor.escribir(board, false);
+        return escritor.cerrar();
+    });
+    ReporteConversion reporte;
+    bool idaVuelta = escrito && convertirTableros(lineas, binario, reporte) && reporte.tableros == static_cast<long long>(tableros.size())
+        && convertirTableros(binario, vuelta, reporte) && leerArchivoCompleto(lineas) == leerArchivoCompleto(vuelta);
+    todo &= informarPrueba(os, "líneas -> .sdb -> líneas, de 9x9 a 64x64", idaVuelta);
+
+    // Con marcas, leyendo directamente los tableros
+    bool conMarcas = conEscritor(marcado, true, [&](auto& escritor) {
+        for (size_t i = 0; i < tableros.size(); i++) escritor.escribir(tableros[i], marcas[i]);
+        return escritor.cerrar();
+    }) && conLector(marcado, [&](auto& lector) {
+        std::unique_ptr<Tablero> board(new Tablero());
+        bool resuelto;
+        size_t leidos = 0;
+        for (; lector.leer(*board, resuelto); leidos++) {
+            if (leidos >= tableros.size() || board->size != tableros[leidos].size || resuelto != marcas[leidos]
+                || std::memcmp(board->celdas, tableros[leidos].celdas, board->size * board->size) != 0) {
+                return false;
+            }
+        }
+        return leidos == tableros.size() && !lector.error;
+    });
+    todo &= informarPrueba(os, ".sdb con marcas de resuelto", conMarcas);
+
+    // Cada daño tiene que terminar en error; ninguno puede dar tableros de más
+    std::string original = leerArchivoCompleto(binario);
+    auto rechaza = [&](const std::string& contenido) {
+        escribirArchivoCompleto(danado, contenido);
+        ReporteConversion r;
+        return !convertirTableros(danado, vuelta, r) && r.tableros < static_cast<long long>(tableros.size());
+    };
+    size_t primerTablero = sizeof FIRMA_BINARIO + CABECERA_BLOQUE_BINARIO;
+    std::string celdaFuera = original;
+    celdaFuera[primerTablero] = static_cast<char>(0xFF);  // 15 en una celda de 9x9
+    std::string dimensionMala = original;
+    dimensionMala[sizeof FIRMA_BINARIO] = 10;
+    std::string bitsMalos = original;
+    bitsMalos[sizeof FIRMA_BINARIO + 1] = 7;
+    std::string cuentaMala = original;
+    cuentaMala[sizeof FIRMA_BINARIO + 4] = 4;  // El primer bloque dice tener un tablero más
+    todo &= informarPrueba(os, ".sdb cortado a mitad de un tablero", rechaza(original.substr(0, original.size() - 3)));
+    todo &= informarPrueba(os, ".sdb sin el último tablero", rechaza(original.substr(0, original.size() - bytesPorTablero(N64x64, false))));
+    todo &= informarPrueba(os, ".sdb cortado en una cabecera", rechaza(original.substr(0, sizeof FIRMA_BINARIO + 3)));
+    todo &= informarPrueba(os, ".sdb con una celda fuera de rango", rechaza(celdaFuera));
+    todo &= informarPrueba(os, ".sdb con una dimensión inválida", rechaza(dimensionMala));
+    todo &= informarPrueba(os, ".sdb con bits por celda equivocados", rechaza(bitsMalos));
+    todo &= informarPrueba(os, ".sdb con la cuenta de un bloque equivocada", rechaza(cuentaMala));
+
+    for (const std::string& ruta : { lineas, binario, vuelta, marcado, danado }) std::remove(ruta.c_str());
+    return todo;
+}
+
+bool solucionCorrecta(const Tablero& puzzle, const Tablero& solucion);
+
+// Variante al azar de un puzzle: permuta bandas, filas dentro de cada banda, pilas, columnas
+// dentro de cada pila y dígitos, y transpone o no. Se arma a mano, sin TransformacionTablero,
+// para que un error en la canonicalización no se compense con el mismo error al armarla.
+void varianteAlAzar(const Tablero& board, std::mt19937_64& rng, Tablero& variante) {
+    int size = board.size;
+    int B = static_cast<int>(std::lround(std::sqrt(size)));
+    auto permutarLineas = [&](int* lineas) {
+        int grupos[MAX_DIMENSION], dentro[MAX_DIMENSION];
+        for (int g = 0; g < B; g++) grupos[g] = g;
+        std::shuffle(grupos, grupos + B, rng);
+        for (int g = 0; g < B; g++) {
+            for (int i = 0; i < B; i++) dentro[i] = i;
+            std::shuffle(dentro, dentro + B, rng);
+            for (int i = 0; i < B; i++) lineas[g * B + i] = grupos[g] * B + dentro[i];
+        }
+    };
+    int filas[MAX_DIMENSION], columnas[MAX_DIMENSION];
+    permutarLineas(filas);
+    permutarLineas(columnas);
+    uint8_t digitos[MAX_DIMENSION + 1];
+    for (int d = 0; d <= size; d++) digitos[d] = static_cast<uint8_t>(d);
+    std::shuffle(digitos + 1, digitos + size + 1, rng);
+    bool transponer = rng() % 2 == 1;
+
+    variante.size = size;
+    for (int row = 0; row < size; row++) {
+        for (int col = 0; col < size; col++) {
+            int pos = transponer ? columnas[col] * size + filas[row] : filas[row] * size + columnas[col];
+            variante.celdas[row * size + col] = digitos[board.celdas[pos]];
+        }
+    }
+}
+
+// Caché: el puzzle y variantes suyas al azar se resuelven a través de la caché, y cada grilla
+// que devuelve se valida contra su propio puzzle. La primera consulta resuelve y las demás
+// aciertan, así que la solución guardada vuelve por deshacerTransformacion con transformaciones
+// distintas. Lo mismo con un puzzle sin solución, que tiene que seguir sin solución.
+bool probarCache(std::ostream& os) {
+    std::mt19937_64 rng(SEMILLA_PRUEBAS);
+    std::unique_ptr<ArenaSolver> arena(new ArenaSolver());
+    bool todo = true;
+    for (int size : { N9x9, N16x16, N25x25 }) {
+        int B = static_cast<int>(std::lround(std::sqrt(size)));
+        std::string dimension = std::to_string(size) + "x" + std::to_string(size);
+
+        // Grilla completa por patrón, con algo más de la mitad de las celdas como pistas
+        Tablero puzzle, sinSolucion;
+        puzzle.size = sinSolucion.size = size;
+        std::memset(sinSolucion.celdas, 0, size * size);
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                int d = (B * (row % B) + row / B + col) % size + 1;
+                puzzle.celdas[row * size + col] = static_cast<uint8_t>(rng() % 20 < 11 ? d : 0);
+                // Sin solución: la primera fila completa salvo su primera celda, cuyo único
+                // candidato aparece en la misma columna fuera de su caja
+                if (row == 0 && col > 0) sinSolucion.celdas[col] = static_cast<uint8_t>(d);
+            }
+        }
+        sinSolucion.celdas[B * size] = 1;
+
+        CacheSoluciones cache(1024);
+        auto resolver = [&](Tablero& p) {
+            return resolverConMotor(p, Motor::Propagacion, *arena) ? EstadoResolucion::Resuelto
+                : EstadoResolucion::SinSolucion;
+        };
+        bool validas = true, sinSolucionSigue = true;
+        for (int i = 0; i <= VARIANTES_PRUEBA_CACHE; i++) {
+            Tablero variante, board;
+            if (i == 0) variante = puzzle;
+            else varianteAlAzar(puzzle, rng, variante);
+            board = variante;
+            validas &= resolverConCache(board, cache, resolver) == EstadoResolucion::Resuelto
+                && solucionCorrecta(variante, board);
+
+            if (i == 0) variante = sinSolucion;
+            else varianteAlAzar(sinSolucion, rng, variante);
+            sinSolucionSigue &= resolverConCache(variante, cache, resolver) == EstadoResolucion::SinSolucion;
+        }
+        EstadisticasCache e = cache.estadisticas();
+        todo &= informarPrueba(os, dimension + ": " + std::to_string(VARIANTES_PRUEBA_CACHE)
+            + " variantes, cada solución válida para su puzzle", validas);
+        todo &= informarPrueba(os, dimension + ": variantes sin solución siguen sin solución", sinSolucionSigue);
+        todo &= informarPrueba(os, dimension + ": las variantes aciertan en la caché (" + std::to_string(e.aciertos)
+            + " de " + std::to_string(e.consultas) + ")", e.aciertos > 0);
+    }
+    return todo;
+}
+
+// Sesión: una corrida de ediciones escritas a mano (poner, reemplazar, una jugada que repite
+// un número, borrar, y quitar pistas hasta dejar varias soluciones para después devolverlas)
+// seguida de ediciones al azar, en 9x9 y 16x16. Después de cada una, conflictos, candidatos,
+// resoluble y única se comparan con lo que da recalcularlos desde cero sobre una copia del
+// tablero que se edita aparte, así que un error en las cuentas por unidad o en el filtrado de
+// las soluciones guardadas aparece en la primera edición que lo dispara.
+bool probarSesion(std::ostream& os) {
+    struct Edicion {
+        int row, col, num; // num 0 borra
+    };
+    std::mt19937_64 rng(SEMILLA_PRUEBAS);
+    std::unique_ptr<ArenaSolver> arena(new ArenaSolver());
+    bool todo = true;
+    for (int size : { N9x9, N16x16 }) {
+        int B = static_cast<int>(std::lround(std::sqrt(size)));
+        std::string dimension = std::to_string(size) + "x" + std::to_string(size);
+        Tablero puzzle, solucion;
+        puzzle.size = size;
+        if (size == N9x9) {
+            const char* linea = "53..7....6..195....98....6.8...6...34..8.3..17...2...6.6....28....419..5....8..79";
+            for (int pos = 0; pos < size * size; pos++) puzzle.celdas[pos] = static_cast<uint8_t>(valorDesdeCaracter(linea[pos], size));
+        }
+        else {
+            for (int pos = 0; pos < size * size; pos++) {
+                int row = pos / size, col = pos % size;
+                puzzle.celdas[pos] = static_cast<uint8_t>(rng() % 2 ? (B * (row % B) + row / B + col) % size + 1 : 0);
+            }
+        }
+        solucion = puzzle;
+        contarSoluciones(solucion, 1, *arena);
+
+        // Guion: la primera celda vacía recibe su número, otro, uno repetido en su fila y se
+        // borra; la primera pista se borra y vuelve; las primeras `size` pistas se quitan y
+        // vuelven en orden inverso
+        std::vector<Edicion> ediciones;
+        int vacia = 0, pista = 0;
+        while (puzzle.celdas[vacia] != 0) vacia++;
+        while (puzzle.celdas[pista] == 0) pista++;
+        int fila = vacia / size, columna = vacia % size, correcto = solucion.celdas[vacia];
+        int repetido = 0;
+        for (int col = 0; col < size && !repetido; col++) repetido = puzzle.en(fila, col);
+        ediciones.push_back({ fila, columna, correcto });
+        ediciones.push_back({ fila, columna, correcto % size + 1 });
+        ediciones.push_back({ fila, columna, repetido });
+        ediciones.push_back({ fila, columna, 0 });
+        ediciones.push_back({ pista / size, pista % size, 0 });
+        ediciones.push_back({ pista / size, pista % size, puzzle.celdas[pista] });
+        std::vector<int> pistas;
+        for (int pos = 0; pos < size * size && static_cast<int>(pistas.size()) < size; pos++) {
+            if (puzzle.celdas[pos] != 0) pistas.push_back(pos);
+        }
+        for (int pos : pistas) ediciones.push_back({ pos / size, pos % size, 0 });
+        for (auto it = pistas.rbegin(); it != pistas.rend(); ++it) ediciones.push_back({ *it / size, *it % size, puzzle.celdas[*it] });
+        // Al azar: el número de la solución, borrar o cualquier número
+        for (int i = 0; i < 300; i++) {
+            int pos = rng() % (size * size);
+            int tipo = rng() % 10;
+            int num = tipo < 4 ? solucion.celdas[pos] : tipo < 7 ? 0 : static_cast<int>(rng() % size) + 1;
+            ediciones.push_back({ pos / size, pos % size, num });
+        }
+
+        SesionSudoku sesion;
+        sesion.cargar(puzzle);
+        Tablero espejo = puzzle;
+        bool cuentas = true, consultas = true;
+        for (size_t i = 0; i < ediciones.size(); i++) {
+            const Edicion& e = ediciones[i];
+            sesion.colocar(e.row, e.col, e.num);
+            espejo.en(e.row, e.col) = static_cast<uint8_t>(e.num);
+
+            // Desde cero: pares (unidad, número) repetidos y números presentes por unidad
+            int conflictos = 0;
+            uint64_t presentes[3 * MAX_DIMENSION] = {};
+            for (int u = 0; u < 3 * size; u++) {
+                int veces[MAX_DIMENSION + 1] = {};
+                for (int k = 0; k < size; k++) {
+                    int row = u < size ? u : u < 2 * size ? k : (u - 2 * size) / B * B + k / B;
+                    int col = u < size ? k : u < 2 * size ? u - size : (u - 2 * size) % B * B + k % B;
+                    int num = espejo.en(row, col);
+                    if (num == 0) continue;
+                    if (++veces[num] == 2) conflictos++;
+                    presentes[u] |= uint64_t(1) << (num - 1);
+                }
+            }
+            cuentas &= std::memcmp(sesion.tablero().celdas, espejo.celdas, size * size) == 0 && sesion.conflictos() == conflictos;
+            uint64_t completo = ~uint64_t(0) >> (64 - size);
+            for (int row = 0; row < size; row++) {
+                for (int col = 0; col < size; col++) {
+                    uint64_t esperado = espejo.en(row, col) != 0 ? 0
+                        : completo & ~(presentes[row] | presentes[size + col] | presentes[2 * size + row / B * B + col / B]);
+                    cuentas &= sesion.candidatos(row, col) == esperado;
+                }
+            }
+
+            // Las consultas se alternan para que a veces la primera después de editar sea única
+            Tablero copia = espejo;
+            long long soluciones = conflictos > 0 ? 0 : contarSoluciones(copia, 2, *arena);
+            if (i % 2 == 0) consultas &= sesion.resoluble() == (soluciones > 0) && sesion.unica() == (soluciones == 1);
+            else consultas &= sesion.unica() == (soluciones == 1) && sesion.resoluble() == (soluciones > 0);
+        }
+        const EstadisticasSesion& e = sesion.estadisticas();
+        todo &= informarPrueba(os, dimension + ": " + std::to_string(ediciones.size())
+            + " ediciones, tablero, conflictos y candidatos como desde cero", cuentas);
+        todo &= informarPrueba(os, dimension + ": resoluble y única como desde cero (" + std::to_string(e.reutilizadas)
+            + " de " + std::to_string(e.consultas) + " con las soluciones guardadas)", consultas && e.reutilizadas > 0);
+    }
+    return todo;
+}
+
+// Corre todas las comprobaciones; true si pasaron
+bool ejecutarPruebas(std::ostream& os) {
+    bool todo = true;
+    os << "Formato binario" << std::endl;
+    todo &= probarFormatoBinario(os);
+    os << "Caché" << std::endl;
+    todo &= probarCache(os);
+    os << "Sesión" << std::endl;
+    todo &= probarSesion(os);
+    os << (todo ? "Todas las comprobaciones pasaron" : "Hubo comprobaciones que fallaron") << std::endl;
+    return todo;
+}
+
+// Dificultad de un puzzle según lo que necesita la propagación para resolverlo
+enum class Dificultad : char { Facil, Media, Dificil, Diabolica };
+const int NUM_DIFICULTADES = 4;
+const int MAX_INTENTOS_GENERACION = 1000; // Grillas que se prueban antes de entregar lo que haya
+const int NODOS_COMPLETAR_POR_CELDA = 16; // Presupuesto para completar una diagonal antes de sortear otra
+const int TAMANO_BLOQUE_GENERACION = 1024;
+
+const char* nombreDificultad(Dificultad dificultad) {
+    static const char* nombres[NUM_DIFICULTADES] = { "facil", "media", "dificil", "diabolica" };
+    return nombres[static_cast<int>(dificultad)];
+}
+
+bool dificultadDesdeNombre(const std::string& nombre, Dificultad& dificultad) {
+    for (int d = 0; d < NUM_DIFICULTADES; d++) {
+        if (nombre == nombreDificultad(static_cast<Dificultad>(d))) {
+            dificultad = static_cast<Dificultad>(d);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Califica un puzzle (con solución) resolviéndolo con propagación: fácil si bastan los
+// singles, media si además hacen falta candidatos bloqueados, difícil si hay que ramificar
+// y diabólica si hacen falta más hipótesis que la dimensión del tablero. Con tope por debajo
+// de difícil no se busca: alcanza con saber que la propagación sola no lo termina.
+template <int B>
+Dificultad calificarPuzzle(const Tablero& board, ArenaOrden<B>& arena, Dificultad tope = Dificultad::Diabolica) {
+    EstadisticasPropagacion stats;
+    if (!inicializarEstado(arena.raiz, board)) return Dificultad::Diabolica;
+    if (tope < Dificultad::Dificil) {
+        if (!propagar(arena.raiz, stats) || arena.raiz.vacias > 0) return Dificultad::Dificil;
+    }
+    else {
+        solveSudokuPropagacion(arena.raiz, arena.pila, stats);
+    }
+    if (stats.ramificaciones > Topologia<B>::size) return Dificultad::Diabolica;
+    if (stats.ramificaciones > 0) return Dificultad::Dificil;
+    if (stats.pointing + stats.claiming > 0) return Dificultad::Media;
+    return Dificultad::Facil;
+}
+
+// Genera una grilla completa al azar: las subcuadrículas de la diagonal no comparten filas
+// ni columnas, así que se llenan con permutaciones y el solver completa el resto. Algunas
+// diagonales dejan al solver retrocediendo sin fin (una en cientos desde 16x16), así que la
+// completación tiene un presupuesto de nodos y al agotarlo se sortea otra diagonal. Como el
+// solver prueba los números en orden, después se aplica una transformación al azar que
+// conserva la validez (renombrar números, permutar filas dentro de cada banda, las bandas
+// entre sí, lo mismo con columnas y pilas, y trasponer). Desde 49x49 completar la diagonal
+// puede llevar al solver a retroceder sin fin, así que se parte de la grilla por
+// desplazamientos (cada fila corre la anterior B lugares, y cada banda uno más) y el azar lo
+// pone solo la transformación.
+template <int B>
+void generarCompleto(std::mt19937_64& rng, ArenaOrden<B>& arena, Tablero& board) {
+    using T = Topologia<B>;
+    constexpr int size = T::size;
+    uint8_t numeros[size];
+    for (int i = 0; i < size; i++) numeros[i] = i + 1;
+
+    board.size = size;
+    if constexpr (B <= 6) {
+        bool completa = false;
+        while (!completa) {
+            std::memset(board.celdas, 0, T::total);
+            for (int b = 0; b < B; b++) {
+                std::shuffle(numeros, numeros + size, rng);
+                for (int i = 0; i < size; i++) board.en(b * B + i / B, b * B + i % B) = numeros[i];
+            }
+            ControlBusqueda control;
+            control.presupuestoNodos = NODOS_COMPLETAR_POR_CELDA * T::total;
+            EstadisticasPropagacion stats;
+            completa = inicializarEstado(arena.raiz, board) && solveSudokuPropagacion(arena.raiz, arena.pila, stats, &control);
+        }
+    }
+    else {
+        for (int r = 0; r < size; r++) {
+            for (int c = 0; c < size; c++) {
+                arena.raiz.celdas[r * size + c] = static_cast<uint8_t>((B * (r % B) + r / B + c) % size + 1);
             }
-            std::cout << std::setw(2) << board[i][j] << " ";
         }
-        std::cout << "\n";
     }
+
+    // Permutación de filas (o columnas): primero las bandas, después dentro de cada banda
+    auto permutacionLineas = [&](int* lineas) {
+        int bandas[B];
+        for (int b = 0; b < B; b++) bandas[b] = b;
+        std::shuffle(bandas, bandas + B, rng);
+        for (int b = 0; b < B; b++) {
+            for (int i = 0; i < B; i++) lineas[b * B + i] = bandas[b] * B + i;
+            std::shuffle(lineas + b * B, lineas + (b + 1) * B, rng);
+        }
+    };
+    int filas[size];
+    int columnas[size];
+    permutacionLineas(filas);
+    permutacionLineas(columnas);
+    std::shuffle(numeros, numeros + size, rng);
+    bool trasponer = rng() & 1;
+    for (int r = 0; r < size; r++) {
+        for (int c = 0; c < size; c++) {
+            int origen = trasponer ? columnas[c] * size + filas[r] : filas[r] * size + columnas[c];
+            board.en(r, c) = numeros[arena.raiz.celdas[origen] - 1];
+        }
+    }
+}
+
+// Arma un puzzle de solución única: parte de una grilla completa y quita las pistas en orden
+// aleatorio, devolviendo cada una que deja más de una solución o que sube la dificultad por
+// encima del objetivo. Devuelve true si la dificultad final es exactamente la pedida.
+template <int B>
+bool generarPuzzle(std::mt19937_64& rng, Dificultad objetivo, ArenaOrden<B>& arena, Tablero& puzzle,
+    Dificultad& obtenida) {
+    using T = Topologia<B>;
+    generarCompleto<B>(rng, arena, puzzle);
+
+    int orden[T::total];
+    for (int pos = 0; pos < T::total; pos++) orden[pos] = pos;
+    std::shuffle(orden, orden + T::total, rng);
+
+    // Si la propagación termina el puzzle sin hipótesis la solución es única (sus deducciones no
+    // descartan soluciones), así que solo se cuentan las soluciones cuando obliga a ramificar.
+    // Para difícil alcanza con la primera pista así: seguir quitando exigiría contar en cada
+    // paso, que en los tableros grandes es lo más caro.
+    Tablero prueba;
+    for (int pos : orden) {
+        uint8_t valor = puzzle.celdas[pos];
+        puzzle.celdas[pos] = 0;
+        Dificultad dificultad = calificarPuzzle<B>(puzzle, arena, objetivo);
+        bool aceptada = dificultad <= objetivo;
+        if (aceptada && dificultad >= Dificultad::Dificil) {
+            prueba = puzzle; // contarSoluciones deja la solución en el tablero
+            aceptada = contarSoluciones<B>(prueba, 2, arena, 1, nullptr) == 1;
+        }
+        if (!aceptada) puzzle.celdas[pos] = valor;
+        else if (dificultad == Dificultad::Dificil && objetivo == Dificultad::Dificil) break;
+    }
+    obtenida = calificarPuzzle<B>(puzzle, arena);
+    return obtenida == objetivo;
+}
+
+// Genera el puzzle número `indice` de la serie de `semilla` con el generador del hilo,
+// resembrado a partir del par para que el resultado no dependa de quién lo calcula.
+// Devuelve las grillas usadas; `obtenida` es la dificultad con la que quedó.
+int generarPuzzleSerie(int tamano, Dificultad objetivo, uint64_t semilla, uint64_t indice, std::mt19937_64& rng,
+    ArenaSolver& arena, Tablero& puzzle, Dificultad& obtenida) {
+    std::seed_seq semillas{ static_cast<uint32_t>(semilla), static_cast<uint32_t>(semilla >> 32),
+        static_cast<uint32_t>(indice), static_cast<uint32_t>(indice >> 32) };
+    rng.seed(semillas);
+    int intentos = 0;
+    despacharOrden(tamano, [&](auto orden) {
+        constexpr int B = decltype(orden)::value;
+        ArenaOrden<B>& arenaOrden = arena.para<B>();
+        do {
+            intentos++;
+        } while (!generarPuzzle<B>(rng, objetivo, arenaOrden, puzzle, obtenida) && intentos < MAX_INTENTOS_GENERACION);
+        return true;
+    });
+    return intentos;
+}
+
+// Resumen de una corrida del generador
+struct ReporteGeneracion {
+    long long total = 0;
+    long long intentos = 0;                         // Grillas completas usadas
+    long long porDificultad[NUM_DIFICULTADES] = {}; // Dificultad con la que salió cada puzzle
+    double segundos = 0;
+};
+
+// Genera `cantidad` puzzles de la dimensión y dificultad pedidas, uno por línea en el mismo
+// formato que lee --lote. Los puzzles se reparten entre los hilos con planificación
+// dinámica y salen por bloques a medida que se completan. Cada puzzle usa su propio
+// generador sembrado con (semilla, índice) (ver generarPuzzleSerie), así que la salida no
+// depende del número de hilos y se reproduce con la misma semilla.
+bool generarLote(int tamano, long long cantidad, Dificultad objetivo, uint64_t semilla,
+    const std::string& rutaSalida, ReporteGeneracion& reporte) {
+    reporte = ReporteGeneracion();
+    if (dimensionDesdeLongitud(static_cast<size_t>(tamano) * tamano) != tamano) return false;
+    int fd = abrirSalida(rutaSalida);
+    if (fd < 0) return false;
+
+    int numHilos = hilosDisponibles();
+    std::vector<std::unique_ptr<ArenaSolver>> arenas(numHilos);
+    for (auto& arena : arenas) arena.reset(new ArenaSolver());
+    std::vector<Tablero> tableros(numHilos);
+    std::vector<std::mt19937_64> generadores(numHilos);
+
+    size_t longitudLinea = static_cast<size_t>(tamano) * tamano + 1;
+    std::vector<char> bufferSalida;
+    std::vector<Dificultad> dificultades;
+    std::vector<int> intentos;
+    bool ok = true;
+    auto inicio = std::chrono::steady_clock::now();
+
+    for (long long primero = 0; ok && primero < cantidad; primero += TAMANO_BLOQUE_GENERACION) {
+        int enBloque = static_cast<int>(std::min<long long>(TAMANO_BLOQUE_GENERACION, cantidad - primero));
+        bufferSalida.resize(enBloque * longitudLinea);
+        dificultades.resize(enBloque);
+        intentos.resize(enBloque);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(numHilos)
+        for (int i = 0; i < enBloque; i++) {
+            int id = omp_get_thread_num();
+            ubicarHilo(id);
+            Tablero& puzzle = tableros[id];
+            intentos[i] = generarPuzzleSerie(tamano, objetivo, semilla, primero + i, generadores[id], *arenas[id],
+                puzzle, dificultades[i]);
+            char* salida = &bufferSalida[i * longitudLinea];
+            for (int pos = 0; pos < tamano * tamano; pos++) salida[pos] = caracterDesdeValor(puzzle.celdas[pos]);
+            salida[tamano * tamano] = '\n';
+        }
+
+        ok = escribirTodo(fd, bufferSalida.data(), bufferSalida.size());
+        for (int i = 0; i < enBloque; i++) {
+            reporte.porDificultad[static_cast<int>(dificultades[i])]++;
+            reporte.intentos += intentos[i];
+        }
+        reporte.total += enBloque;
+    }
+
+    reporte.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    cerrarSalida(fd);
+    return ok;
+}
+
+void imprimirReporteGeneracion(const ReporteGeneracion& reporte, std::ostream& os) {
+    os << "Generados: " << reporte.total << " puzzles con " << reporte.intentos << " grillas en "
+        << std::fixed << std::setprecision(3) << reporte.segundos << " s ("
+        << std::setprecision(1) << (reporte.segundos > 0 ? reporte.total / reporte.segundos : 0)
+        << " puzzles/s)" << std::endl;
+    os << "Dificultad:";
+    for (int d = 0; d < NUM_DIFICULTADES; d++) {
+        os << " " << nombreDificultad(static_cast<Dificultad>(d)) << " = " << reporte.porDificultad[d];
+    }
+    os << std::endl << std::defaultfloat;
+}
+
+// Benchmark reproducible: cada motor sobre un corpus fijo por dimensión, con calentamiento,
+// repeticiones y estadísticas robustas (mediana y MAD) en nanosegundos.
+
+// Corpus estándar: puzzles generados con una semilla fija, así que son los mismos en cada
+// corrida y los números se pueden comparar entre versiones mientras no cambie el generador
+struct CorpusBench {
+    int tamano;
+    int cantidad;
+    Dificultad dificultad;
+};
+const CorpusBench CORPUS_BENCH[] = {
+    { N9x9, 200, Dificultad::Dificil },
+    { N16x16, 24, Dificultad::Dificil },
+    { N25x25, 6, Dificultad::Dificil },
+    // Generar los tableros grandes cuesta segundos por puzzle, así que van pocos y de
+    // dificultad media, que la propagación resuelve sin ramificar
+    { N36x36, 4, Dificultad::Media },
+    { N49x49, 2, Dificultad::Media },
+    { N64x64, 1, Dificultad::Media },
+};
+const uint64_t SEMILLA_BENCH = 20240101;
+
+struct OpcionesBench {
+    int tamano = 0;                // 0: todas las dimensiones del corpus
+    int repeticiones = 5;
+    int calentamiento = 1;         // Pasadas completas que no se registran
+    std::string formato = "texto"; // texto, json o csv
+    bool soloEscalado = false;     // Solo las curvas de escalado de los motores paralelos
+};
+
+// Resultado de un motor sobre el corpus de una dimensión con cierta cantidad de hilos. Cada
+// muestra es la latencia de un puzzle en una repetición; en el modo por lotes, donde los
+// puzzles se resuelven a la vez, es el tiempo de la repetición dividido por el corpus.
+struct MedicionBench {
+    std::string motor;
+    int tamano = 0;
+    int hilos = 1;
+    int puzzles = 0;
+    long long muestras = 0;
+    long long fallidos = 0;
+    double medianaNs = 0;
+    double madNs = 0;           // Desviación absoluta mediana
+    double minimoNs = 0;
+    double p90Ns = 0;
+    double p99Ns = 0;
+    double puzzlesPorSegundo = 0;
+    double nodosPorSegundo = 0; // 0 en los motores que no cuentan nodos
+    double aceleracion = 1;     // Respecto del mismo motor con un hilo
+};
+
+// Mediana, MAD y percentiles de las muestras; las reordena
+void resumirMuestras(std::vector<double>& muestras, MedicionBench& medicion) {
+    medicion.muestras = muestras.size();
+    if (muestras.empty()) return;
+    medicion.minimoNs = *std::min_element(muestras.begin(), muestras.end());
+    medicion.p90Ns = percentil(muestras, 0.90);
+    medicion.p99Ns = percentil(muestras, 0.99);
+    medicion.medianaNs = percentil(muestras, 0.50);
+    std::vector<double> desvios(muestras.size());
+    for (size_t i = 0; i < muestras.size(); i++) desvios[i] = std::abs(muestras[i] - medicion.medianaNs);
+    medicion.madNs = percentil(desvios, 0.50);
+}
+
+// La solución respeta las pistas del puzzle y es una grilla válida
+bool solucionCorrecta(const Tablero& puzzle, const Tablero& solucion) {
+    int total = puzzle.size * puzzle.size;
+    for (int pos = 0; pos < total; pos++) {
+        if (puzzle.celdas[pos] != 0 && puzzle.celdas[pos] != solucion.celdas[pos]) return false;
+    }
+    return despacharOrden(puzzle.size, [&](auto orden) {
+        constexpr int B = decltype(orden)::value;
+        return validarSolucion<B>(solucion.celdas);
+    });
+}
+
+// Mide un motor que resuelve de a un puzzle; resolver(board, stats) deja la solución en board
+template <typename F>
+MedicionBench medirPorPuzzle(const char* motor, int hilos, const std::vector<Tablero>& corpus,
+    const OpcionesBench& opciones, F resolver) {
+    MedicionBench medicion;
+    medicion.motor = motor;
+    medicion.tamano = corpus[0].size;
+    medicion.hilos = hilos;
+    medicion.puzzles = corpus.size();
+
+    std::vector<double> muestras;
+    muestras.reserve(corpus.size() * opciones.repeticiones);
+    Tablero board;
+    long long nodos = 0;
+    double totalNs = 0;
+    for (int r = -opciones.calentamiento; r < opciones.repeticiones; r++) {
+        for (const Tablero& puzzle : corpus) {
+            board = puzzle;
+            EstadisticasPropagacion stats;
+            auto inicio = std::chrono::steady_clock::now();
+            bool resuelto = resolver(board, stats);
+            double ns = nanosegundosDesde(inicio);
+            if (r < 0) continue;
+            muestras.push_back(ns);
+            totalNs += ns;
+            nodos += stats.nodos;
+            if (!resuelto || !solucionCorrecta(puzzle, board)) medicion.fallidos++;
+        }
+    }
+    medicion.puzzlesPorSegundo = totalNs > 0 ? muestras.size() * 1e9 / totalNs : 0;
+    medicion.nodosPorSegundo = totalNs > 0 ? nodos * 1e9 / totalNs : 0;
+    resumirMuestras(muestras, medicion);
+    return medicion;
+}
+
+// Mide el modo por lotes: el corpus entero repartido entre `hilos` como en resolverLote,
+// con una arena por hilo y el motor de propagación
+MedicionBench medirLote(int hilos, const std::vector<Tablero>& corpus, const OpcionesBench& opciones,
+    std::vector<std::unique_ptr<ArenaSolver>>& arenas) {
+    MedicionBench medicion;
+    medicion.motor = "lote";
+    medicion.tamano = corpus[0].size;
+    medicion.hilos = hilos;
+    medicion.puzzles = corpus.size();
+
+    int cantidad = corpus.size();
+    std::vector<Tablero> tableros(cantidad);
+    std::vector<char> resueltos(cantidad);
+    std::vector<long long> nodosPuzzle(cantidad);
+    std::vector<double> muestras;
+    long long nodos = 0;
+    double totalNs = 0;
+    for (int r = -opciones.calentamiento; r < opciones.repeticiones; r++) {
+        auto inicio = std::chrono::steady_clock::now();
+#pragma omp parallel for schedule(dynamic, CHUNK_LOTE) num_threads(hilos)
+        for (int i = 0; i < cantidad; i++) {
+            int id = omp_get_thread_num();
+            ubicarHilo(id);
+            EstadisticasPropagacion stats;
+            tableros[i] = corpus[i];
+            resueltos[i] = resolverConMotor(tableros[i], Motor::Propagacion, *arenas[id], &stats);
+            nodosPuzzle[i] = stats.nodos;
+        }
+        double ns = nanosegundosDesde(inicio);
+        if (r < 0) continue;
+        muestras.push_back(ns / cantidad);
+        totalNs += ns;
+        for (int i = 0; i < cantidad; i++) {
+            nodos += nodosPuzzle[i];
+            if (!resueltos[i] || !solucionCorrecta(corpus[i], tableros[i])) medicion.fallidos++;
+        }
+    }
+    medicion.puzzlesPorSegundo = totalNs > 0 ? static_cast<double>(cantidad) * muestras.size() * 1e9 / totalNs : 0;
+    medicion.nodosPorSegundo = totalNs > 0 ? nodos * 1e9 / totalNs : 0;
+    resumirMuestras(muestras, medicion);
+    return medicion;
 }
 
-// Función para verificar si es seguro colocar un número en una celda en Sudoku de cualquier tamaño
-bool isSafe(int** board, int size, int row, int col, int num) {
-    // Verificar la fila
-    for (int x = 0; x < size; x++) {
-        if (board[row][x] == num) {
-            return false;
+// Cantidades de hilos de las curvas de escalado: potencias de dos hasta el máximo, y el máximo
+std::vector<int> nivelesHilos(int maximo) {
+    std::vector<int> niveles;
+    for (int hilos = 1; hilos < maximo; hilos *= 2) niveles.push_back(hilos);
+    niveles.push_back(maximo);
+    return niveles;
+}
+
+// Corre todos los motores sobre el corpus de cada dimensión pedida. Los secuenciales se miden
+// con un hilo; la búsqueda paralela, la de filas, el portafolio y el modo por lotes con cada
+// nivel de hilos.
+std::vector<MedicionBench> ejecutarBench(const OpcionesBench& opciones) {
+    int maximoHilos = hilosDisponibles();
+    std::vector<std::unique_ptr<ArenaSolver>> arenas(maximoHilos);
+    for (auto& arena : arenas) arena.reset(new ArenaSolver());
+    ArenaSolver& arena = *arenas[0];
+    std::mt19937_64 rng;
+    std::vector<MedicionBench> mediciones;
+
+    for (const CorpusBench& definicion : CORPUS_BENCH) {
+        if (opciones.tamano != 0 && opciones.tamano != definicion.tamano) continue;
+        std::vector<Tablero> corpus(definicion.cantidad);
+        for (int i = 0; i < definicion.cantidad; i++) {
+            Dificultad obtenida;
+            generarPuzzleSerie(definicion.tamano, definicion.dificultad, SEMILLA_BENCH, i, rng, arena, corpus[i], obtenida);
         }
-    }
-    // Verificar la columna
-    for (int x = 0; x < size; x++) {
-        if (board[x][col] == num) {
-            return false;
+
+        // Sin propagación la búsqueda crece demasiado con la dimensión: en el corpus de 16x16 el
+        // clásico y el de máscaras tardan segundos por puzzle, en el de 25x25 también MRV, y
+        // desde 36x36 Dancing Links (sin las reglas de subcuadrícula y línea) no termina.
+        // Cada motor se mide hasta la dimensión en la que sigue siendo práctico.
+        struct MotorSecuencial {
+            Motor motor;
+            const char* nombre;
+            int dimensionMaxima;
+        };
+        const MotorSecuencial secuenciales[] = {
+            { Motor::Clasico, "clasico", N9x9 },
+            { Motor::Bitmask, "bitmask", N9x9 },
+            { Motor::MRV, "mrv", N16x16 },
+            { Motor::Propagacion, "propagacion", MAX_DIMENSION },
+            { Motor::DLX, "dlx", DIMENSION_MAXIMA_DLX },
+        };
+        for (const MotorSecuencial& m : secuenciales) {
+            if (opciones.soloEscalado || definicion.tamano > m.dimensionMaxima) continue;
+            mediciones.push_back(medirPorPuzzle(m.nombre, 1, corpus, opciones, [&](Tablero& board, EstadisticasPropagacion& stats) {
+                return resolverConMotor(board, m.motor, arena, &stats);
+            }));
         }
-    }
-    // Verificar la subcuadrícula
-    int subSize = static_cast<int>(std::sqrt(size));
-    int startRow = row - row % subSize;
-    int startCol = col - col % subSize;
-    for (int i = 0; i < subSize; i++) {
-        for (int j = 0; j < subSize; j++) {
-            if (board[startRow + i][startCol + j] == num) {
-                return false;
+
+        // Curvas de escalado; la aceleración se mide contra el primer nivel (un hilo)
+        auto escalar = [&](auto medir) {
+            size_t base = mediciones.size();
+            for (int hilos : nivelesHilos(maximoHilos)) {
+                mediciones.push_back(medir(hilos));
+                if (mediciones[base].puzzlesPorSegundo > 0) {
+                    mediciones.back().aceleracion = mediciones.back().puzzlesPorSegundo / mediciones[base].puzzlesPorSegundo;
+                }
             }
-        }
+        };
+        escalar([&](int hilos) {
+            return medirPorPuzzle("paralelo", hilos, corpus, opciones, [&](Tablero& board, EstadisticasPropagacion& stats) {
+                return despacharOrden(board.size, [&](auto orden) {
+                    constexpr int B = decltype(orden)::value;
+                    return solveSudokup<B>(board, arena.para<B>(), &stats, hilos);
+                });
+            });
+        });
+        escalar([&](int hilos) {
+            return medirPorPuzzle("filas", hilos, corpus, opciones, [&](Tablero& board, EstadisticasPropagacion& stats) {
+                return resolverSudokuPorFilas(board, arena, &stats, hilos);
+            });
+        });
+        escalar([&](int hilos) {
+            return medirPorPuzzle("portafolio", hilos, corpus, opciones, [&](Tablero& board, EstadisticasPropagacion& stats) {
+                return despacharOrden(board.size, [&](auto orden) {
+                    constexpr int B = decltype(orden)::value;
+                    return resolverPortafolio<B>(board, hilos, &stats) == EstadoResolucion::Resuelto;
+                });
+            });
+        });
+        escalar([&](int hilos) { return medirLote(hilos, corpus, opciones, arenas); });
     }
-    return true;
+    return mediciones;
 }
 
-// Algoritmo de backtracking con memoria dinámica y poda
-bool solveSudoku(int** board, int size, int row, int col) {
-    // Si hemos llegado al final del tablero
-    if (row == size) return true;
-    // Si la columna se sale de los límites, pasa a la siguiente fila
-    if (col == size) return solveSudoku(board, size, row + 1, 0);
-    // Si la celda ya tiene un valor, pasa a la siguiente
-    if (board[row][col] != 0) return solveSudoku(board, size, row, col + 1);
-
-    // Poda: verificar números válidos en la posición actual
-    for (int num = 1; num <= size; num++) {
-        if (isSafe(board, size, row, col, num)) {
-            board[row][col] = num; // Colocar el número provisionalmente
-            if (solveSudoku(board, size, row, col + 1)) return true; // Avanza
-            board[row][col] = 0; // Backtrack: quitar el número
-        }
+void escribirBenchTexto(const std::vector<MedicionBench>& mediciones, std::ostream& os) {
+    os << std::left << std::setw(12) << "motor" << std::right << std::setw(6) << "dim" << std::setw(6) << "hilos"
+        << std::setw(14) << "mediana" << std::setw(14) << "MAD" << std::setw(14) << "p90" << std::setw(14) << "p99"
+        << std::setw(14) << "puzzles/s" << std::setw(14) << "nodos/s" << std::setw(8) << "acel." << std::setw(8) << "fallos"
+        << std::endl;
+    for (const MedicionBench& m : mediciones) {
+        os << std::left << std::setw(12) << m.motor << std::right << std::setw(6) << m.tamano << std::setw(6) << m.hilos
+            << std::setw(14) << formatearDuracion(m.medianaNs) << std::setw(14) << formatearDuracion(m.madNs)
+            << std::setw(14) << formatearDuracion(m.p90Ns) << std::setw(14) << formatearDuracion(m.p99Ns)
+            << std::fixed << std::setprecision(1) << std::setw(14) << m.puzzlesPorSegundo
+            << std::setprecision(0) << std::setw(14) << m.nodosPorSegundo
+            << std::setprecision(2) << std::setw(8) << m.aceleracion << std::setw(8) << m.fallidos
+            << std::defaultfloat << std::endl;
     }
-    return false; // Si no hay ninguna opción válida, se devuelve falso
 }
 
-// Función para inicializar un tablero con memoria dinámica
-int** initializeBoard(const std::vector<std::vector<int>>& initialBoard) {
-    int size = initialBoard.size();
-    int** board = new int* [size];
-    for (int i = 0; i < size; i++) {
-        board[i] = new int[size];
-        for (int j = 0; j < size; j++) {
-            board[i][j] = initialBoard[i][j];
-        }
+void escribirBenchCSV(const std::vector<MedicionBench>& mediciones, std::ostream& os) {
+    os << "motor,tamano,hilos,puzzles,muestras,fallidos,mediana_ns,mad_ns,min_ns,p90_ns,p99_ns,"
+        << "puzzles_por_s,nodos_por_s,aceleracion" << std::endl;
+    os << std::fixed << std::setprecision(1);
+    for (const MedicionBench& m : mediciones) {
+        os << m.motor << "," << m.tamano << "," << m.hilos << "," << m.puzzles << "," << m.muestras << ","
+            << m.fallidos << "," << m.medianaNs << "," << m.madNs << "," << m.minimoNs << "," << m.p90Ns << ","
+            << m.p99Ns << "," << m.puzzlesPorSegundo << "," << m.nodosPorSegundo << ","
+            << std::setprecision(3) << m.aceleracion << std::setprecision(1) << std::endl;
     }
-    return board;
+    os << std::defaultfloat;
 }
 
-// Función para liberar la memoria dinámica del tablero
-void freeBoard(int** board, int size) {
-    for (int i = 0; i < size; i++) {
-        delete[] board[i];
+// JSON con la configuración de la corrida (para saber qué se compara) y una entrada por medición
+void escribirBenchJSON(const OpcionesBench& opciones, const std::vector<MedicionBench>& mediciones, std::ostream& os) {
+#ifdef __VERSION__
+    const char* compilador = __VERSION__;
+#else
+    const char* compilador = "desconocido";
+#endif
+    os << "{" << std::endl;
+    os << "  \"configuracion\": {\"semilla\": " << SEMILLA_BENCH << ", \"repeticiones\": " << opciones.repeticiones
+        << ", \"calentamiento\": " << opciones.calentamiento << ", \"hilos_maximos\": " << hilosDisponibles()
+        << ", \"fijar\": " << (opcionesHilos.fijar ? "true" : "false") << ", \"sin_smt\": " << (opcionesHilos.sinSMT ? "true" : "false")
+        << ", \"nodos_numa\": " << topologiaCPU().nodos
+        << ", \"avx2\": " << (usarAVX2 ? "true" : "false") << ", \"compilador\": \"" << compilador << "\"}," << std::endl;
+    os << "  \"mediciones\": [" << std::endl;
+    os << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < mediciones.size(); i++) {
+        const MedicionBench& m = mediciones[i];
+        os << "    {\"motor\": \"" << m.motor << "\", \"tamano\": " << m.tamano << ", \"hilos\": " << m.hilos
+            << ", \"puzzles\": " << m.puzzles << ", \"muestras\": " << m.muestras << ", \"fallidos\": " << m.fallidos
+            << ", \"mediana_ns\": " << m.medianaNs << ", \"mad_ns\": " << m.madNs << ", \"min_ns\": " << m.minimoNs
+            << ", \"p90_ns\": " << m.p90Ns << ", \"p99_ns\": " << m.p99Ns
+            << ", \"puzzles_por_s\": " << m.puzzlesPorSegundo << ", \"nodos_por_s\": " << m.nodosPorSegundo
+            << ", \"aceleracion\": " << std::setprecision(3) << m.aceleracion << std::setprecision(1) << "}"
+            << (i + 1 < mediciones.size() ? "," : "") << std::endl;
     }
-    delete[] board;
+    os << "  ]" << std::endl << "}" << std::endl << std::defaultfloat;
 }
 
-// Función para imprimir el tablero de Sudoku
-void printBoard(int** board, int size) {
-    std::cout << "{" << std::endl;
-    std::cout << "\t\"board\": [" << std::endl;
-    for (int i = 0; i < size; i++) {
-        std::cout << "\t\t[";
-        for (int j = 0; j < size; j++) {
-            std::cout << board[i][j];
-            if (j != size - 1) std::cout << ", ";
+// Informe de escalado: la topología y la ubicación de los hilos, y por cada motor paralelo y
+// nivel de hilos el rendimiento, la aceleración contra un hilo y la eficiencia (aceleración
+// dividida por los hilos)
+void escribirEscalado(const std::vector<MedicionBench>& mediciones, std::ostream& os) {
+    imprimirTopologia(os);
+    os << std::left << std::setw(12) << "motor" << std::right << std::setw(6) << "dim" << std::setw(6) << "hilos"
+        << std::setw(14) << "mediana" << std::setw(14) << "puzzles/s" << std::setw(8) << "acel." << std::setw(8) << "efic."
+        << (opcionesHilos.fijar ? "  cpus" : "") << std::endl;
+    for (const MedicionBench& m : mediciones) {
+        os << std::left << std::setw(12) << m.motor << std::right << std::setw(6) << m.tamano << std::setw(6) << m.hilos
+            << std::setw(14) << formatearDuracion(m.medianaNs)
+            << std::fixed << std::setprecision(1) << std::setw(14) << m.puzzlesPorSegundo
+            << std::setprecision(2) << std::setw(8) << m.aceleracion
+            << std::setprecision(0) << std::setw(7) << 100 * m.aceleracion / m.hilos << "%";
+        if (opcionesHilos.fijar) {
+            for (int i = 0; i < m.hilos; i++) os << (i == 0 ? "  " : ",") << cpuDeHilo(i).id;
         }
-        std::cout << "]";
-        if (i != size - 1) std::cout << ",";
-        std::cout << std::endl;
+        os << std::defaultfloat << std::endl;
     }
-    std::cout << "\t]" << std::endl;
-    std::cout << "}" << std::endl;
 }
 
-// Función principal para resolver un Sudoku de cualquier tamaño
-void resolverSudoku(const std::vector<std::vector<int>>& initialBoard) {
-    int size = initialBoard.size();
-    int** board = initializeBoard(initialBoard);
+#ifndef _WIN32
+// Modo servicio: un proceso que queda escuchando en un socket de dominio Unix. El protocolo
+// es de líneas: cada pedido es "<id> <puzzle>" con el puzzle en el formato de línea, y cada
+// respuesta es "<id> <estado> <solución> <latencia_us>", donde el estado es R (resuelto),
+// S (sin solución), I (inválido) o A (agotó los límites) y la solución repite el puzzle si
+// no se resolvió. Las respuestas salen cuando están listas, no en el orden de los pedidos;
+// el id permite emparejarlas. La línea "#metricas" devuelve las métricas del servicio.
+const int LOTE_SERVICIO = 32;              // Pedidos que un trabajador toma a lo sumo de una vez
+const int COLA_MAXIMA_SERVICIO = 1 << 16;  // Con más pedidos encolados se deja de leer los sockets
+const int INTERVALO_METRICAS_SEG = 5;      // Cada cuánto se imprimen las métricas en la salida de errores
+const int BUFFER_SOCKET = 1 << 16;
 
-    // Imprimir el Sudoku antes de resolverlo
-    std::cout << "Sudoku a resolver:" << std::endl;
-    printBoard(board, size);
+volatile std::sig_atomic_t senalTerminar = 0;
+
+void manejarSenalTerminar(int) {
+    senalTerminar = 1;
+}
+
+// Socket de un cliente; se cierra cuando ya no lo usa ni la lectura ni ningún trabajador
+struct ConexionServicio {
+    int fd;
+    std::mutex mtxEscritura; // Las respuestas de distintos trabajadores no se intercalan
+
+    explicit ConexionServicio(int descriptor) : fd(descriptor) {}
+    ~ConexionServicio() { close(fd); }
+};
 
-    // Medir el tiempo de resolución
-    auto start = std::chrono::high_resolution_clock::now();
-    if (solveSudoku(board, size, 0, 0)) {
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+struct PedidoServicio {
+    std::shared_ptr<ConexionServicio> conexion;
+    std::string linea;
+    std::chrono::steady_clock::time_point llegada;
+};
+
+// Contadores del servicio; la latencia va a un histograma por potencias de dos de microsegundos
+struct MetricasServicio {
+    static const int CUBETAS = 32;
+    std::atomic<long long> conexiones{ 0 };
+    std::atomic<long long> recibidos{ 0 };
+    std::atomic<long long> respondidos{ 0 };
+    std::atomic<long long> lotes{ 0 };
+    std::atomic<long long> porEstado[4] = {};
+    std::atomic<long long> latenciaTotalUs{ 0 };
+    std::atomic<long long> histograma[CUBETAS] = {};
+    std::atomic<long long> colaMaxima{ 0 };
+    std::atomic<long long> conPropagacion{ 0 }; // Pedidos con DLX que se resolvieron con propagación
 
-        // Calcular horas, minutos, segundos y milisegundos
-        int hours = duration_ms / 3600000;
-        int minutes = (duration_ms % 3600000) / 60000;
-        int seconds = (duration_ms % 60000) / 1000;
-        int milliseconds = duration_ms % 1000;
+    void registrarLatencia(long long us) {
+        int cubeta = 0;
+        while (cubeta < CUBETAS - 1 && (1LL << cubeta) <= us) cubeta++;
+        histograma[cubeta].fetch_add(1, std::memory_order_relaxed);
+        latenciaTotalUs.fetch_add(us, std::memory_order_relaxed);
+    }
 
-        std::cout << "Sudoku resuelto exitosamente en ";
-        if (hours > 0) {
-            std::cout << hours << " horas, " << minutes << " minutos, " << seconds << " segundos y " << milliseconds << " milisegundos." << std::endl;
+    // Cota superior del percentil p (0..1) según el histograma
+    long long percentilUs(double p) const {
+        long long total = 0;
+        for (int i = 0; i < CUBETAS; i++) total += histograma[i].load();
+        long long objetivo = static_cast<long long>(std::ceil(p * total));
+        long long acumulado = 0;
+        for (int i = 0; i < CUBETAS; i++) {
+            acumulado += histograma[i].load();
+            if (acumulado >= objetivo && acumulado > 0) return 1LL << i;
         }
-        else if (minutes > 0) {
-            std::cout << minutes << " minutos, " << seconds << " segundos y " << milliseconds << " milisegundos." << std::endl;
+        return 0;
+    }
+};
+
+class ServicioSudoku {
+public:
+    ServicioSudoku(const std::string& rutaSocket, const LimitesResolucion& limitesPedido, int hilos,
+        CacheSoluciones* cacheCompartida = nullptr)
+        : ruta(rutaSocket), limites(limitesPedido), numHilos(hilos), cache(cacheCompartida) {}
+
+    // Escucha hasta recibir SIGINT o SIGTERM; los pedidos ya encolados se responden antes de salir
+    bool ejecutar() {
+        escucha = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (escucha < 0) return false;
+        sockaddr_un direccion;
+        std::memset(&direccion, 0, sizeof(direccion));
+        direccion.sun_family = AF_UNIX;
+        if (ruta.size() >= sizeof(direccion.sun_path)) {
+            close(escucha);
+            return false;
         }
-        else if (seconds > 0) {
-            std::cout << seconds << " segundos y " << milliseconds << " milisegundos." << std::endl;
+        std::strcpy(direccion.sun_path, ruta.c_str());
+        unlink(ruta.c_str()); // Restos de una corrida anterior
+        if (bind(escucha, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 || listen(escucha, 128) != 0) {
+            close(escucha);
+            return false;
         }
-        else {
-            std::cout << milliseconds << " milisegundos." << std::endl;
+
+        std::signal(SIGPIPE, SIG_IGN); // Un cliente que se va no debe terminar el proceso
+        std::signal(SIGINT, manejarSenalTerminar);
+        std::signal(SIGTERM, manejarSenalTerminar);
+        inicio = std::chrono::steady_clock::now();
+
+        // Los trabajadores arrancan con sus arenas ya reservadas, antes del primer pedido
+        std::vector<std::thread> trabajadores;
+        for (int i = 0; i < numHilos; i++) trabajadores.emplace_back(&ServicioSudoku::trabajador, this, i);
+        std::cerr << "Servicio escuchando en " << ruta << " con " << numHilos << " hilos" << std::endl;
+
+        atender();
+
+        {
+            std::lock_guard<std::mutex> guard(mtxCola);
+            terminar = true;
         }
-        printBoard(board, size);
+        cvCola.notify_all();
+        for (auto& t : trabajadores) t.join();
+        close(escucha);
+        unlink(ruta.c_str());
+        imprimirMetricas(std::cerr);
+        return true;
     }
-    else {
-        std::cout << "No se pudo resolver el Sudoku." << std::endl;
+
+    void imprimirMetricas(std::ostream& os) {
+        os << lineaMetricas() << std::endl;
     }
 
-    freeBoard(board, size);
-}
+private:
+    struct EntradaConexion {
+        std::shared_ptr<ConexionServicio> conexion;
+        std::string pendiente; // Final de la última lectura, sin salto de línea todavía
+    };
 
+    std::string ruta;
+    LimitesResolucion limites;
+    int numHilos;
+    CacheSoluciones* cache;
+    int escucha = -1;
+    std::chrono::steady_clock::time_point inicio;
 
-// Función para verificar si es seguro colocar un número en una celda en Sudoku de cualquier tamaño (paralelizada)
-bool isSafep(int** board, int size, int row, int col, int num) {
-    for (int x = 0; x < size; x++) {
-        if (board[row][x] == num || board[x][col] == num)
-            return false;
+    std::mutex mtxCola;
+    std::condition_variable cvCola;
+    std::deque<PedidoServicio> cola;
+    std::atomic<long long> profundidad{ 0 }; // Tamaño de la cola, legible sin el lock
+    bool terminar = false;
+    MetricasServicio metricas;
+
+    std::string lineaMetricas() {
+        double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        long long respondidos = metricas.respondidos.load();
+        long long lotes = metricas.lotes.load();
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1) << "#metricas conexiones=" << metricas.conexiones.load()
+            << " recibidos=" << metricas.recibidos.load() << " respondidos=" << respondidos
+            << " resueltos=" << metricas.porEstado[0].load() << " sin_solucion=" << metricas.porEstado[1].load()
+            << " invalidos=" << metricas.porEstado[2].load() << " agotados=" << metricas.porEstado[3].load()
+            << " cola=" << profundidad.load() << " cola_max=" << metricas.colaMaxima.load()
+            << " lote_medio=" << (lotes > 0 ? static_cast<double>(respondidos) / lotes : 0)
+            << " por_segundo=" << (segundos > 0 ? respondidos / segundos : 0)
+            << " latencia_media_us=" << (respondidos > 0 ? static_cast<double>(metricas.latenciaTotalUs.load()) / respondidos : 0)
+            << " p50_us<=" << metricas.percentilUs(0.50) << " p99_us<=" << metricas.percentilUs(0.99);
+        if (limites.motor == Motor::DLX) os << " con_propagacion=" << metricas.conPropagacion.load();
+        if (cache) {
+            EstadisticasCache e = cache->estadisticas();
+            os << " cache_aciertos=" << e.aciertos << " cache_tasa=" << 100.0 * e.tasaAciertos() << "%";
+        }
+        return os.str();
     }
-    int subSize = static_cast<int>(std::sqrt(size));
-    int startRow = row - row % subSize;
-    int startCol = col - col % subSize;
-    for (int i = 0; i < subSize; i++) {
-        for (int j = 0; j < subSize; j++) {
-            if (board[startRow + i][startCol + j] == num)
-                return false;
+
+    void encolar(std::vector<PedidoServicio>& pedidos) {
+        if (pedidos.empty()) return;
+        long long tam;
+        {
+            std::lock_guard<std::mutex> guard(mtxCola);
+            for (auto& pedido : pedidos) cola.push_back(std::move(pedido));
+            tam = cola.size();
         }
+        profundidad.store(tam);
+        metricas.recibidos.fetch_add(pedidos.size());
+        long long maxima = metricas.colaMaxima.load();
+        while (tam > maxima && !metricas.colaMaxima.compare_exchange_weak(maxima, tam)) {}
+        if (pedidos.size() == 1) cvCola.notify_one();
+        else cvCola.notify_all();
+        pedidos.clear();
     }
-    return true;
-}
 
-// Algoritmo de backtracking con memoria dinámica y poda (paralelizado)
-bool solveSudokup(int** board, int size, int row, int col) {
-    if (row == size) return true;
-    if (col == size) return solveSudokup(board, size, row + 1, 0);
-    if (board[row][col] != 0) return solveSudokup(board, size, row, col + 1);
+    // Separa las líneas completas de lo leído; las de métricas se contestan aquí mismo
+    void separarPedidos(EntradaConexion& entrada, std::vector<PedidoServicio>& pedidos) {
+        auto ahora = std::chrono::steady_clock::now();
+        size_t desde = 0;
+        size_t salto;
+        while ((salto = entrada.pendiente.find('\n', desde)) != std::string::npos) {
+            size_t longitud = salto - desde;
+            if (longitud > 0 && entrada.pendiente[salto - 1] == '\r') longitud--;
+            if (longitud > 0) {
+                if (entrada.pendiente.compare(desde, longitud, "#metricas") == 0) {
+                    std::string linea = lineaMetricas() + "\n";
+                    std::lock_guard<std::mutex> guard(entrada.conexion->mtxEscritura);
+                    escribirTodo(entrada.conexion->fd, linea.data(), linea.size());
+                }
+                else {
+                    pedidos.push_back({ entrada.conexion, entrada.pendiente.substr(desde, longitud), ahora });
+                }
+            }
+            desde = salto + 1;
+        }
+        entrada.pendiente.erase(0, desde);
+    }
 
-    for (int num = 1; num <= size; num++) {
-        if (isSafep(board, size, row, col, num)) {
-            board[row][col] = num;
-
-            std::vector<std::future<bool>> futures;
-            bool solucionEncontrada = false;
-
-            // Crear un pool de hilos para distribuir el trabajo en ramas paralelas
-            for (int i = 0; i < NUM_HILOS && !solucionEncontrada; ++i) {
-                futures.emplace_back(std::async(std::launch::async, [=, &board, &solucionEncontrada]() {
-                    if (solveSudokup(board, size, row, col + 1)) {
-                        std::lock_guard<std::mutex> guard(mtx);
-                        solucionEncontrada = true;
-                        return true;
-                    }
-                    return false;
-                    }));
+    // Hilo de entrada: acepta conexiones y lee pedidos con poll, sin resolver nada
+    void atender() {
+        std::vector<EntradaConexion> conexiones;
+        std::vector<pollfd> fds;
+        std::vector<PedidoServicio> pedidos;
+        std::vector<char> buffer(BUFFER_SOCKET);
+        auto ultimoReporte = std::chrono::steady_clock::now();
+
+        while (!senalTerminar) {
+            fds.clear();
+            fds.push_back({ escucha, POLLIN, 0 });
+            // Con la cola llena no se lee más: los clientes esperan en sus sockets
+            short eventos = profundidad.load() < COLA_MAXIMA_SERVICIO ? POLLIN : 0;
+            for (const EntradaConexion& entrada : conexiones) fds.push_back({ entrada.conexion->fd, eventos, 0 });
+            int listos = poll(fds.data(), fds.size(), 100);
+
+            auto ahora = std::chrono::steady_clock::now();
+            if (ahora - ultimoReporte >= std::chrono::seconds(INTERVALO_METRICAS_SEG)) {
+                imprimirMetricas(std::cerr);
+                ultimoReporte = ahora;
             }
+            if (listos <= 0) continue;
 
-            for (auto& future : futures) {
-                if (future.get()) return true;
+            // De atrás hacia adelante para poder quitar las conexiones cerradas
+            for (int i = static_cast<int>(conexiones.size()) - 1; i >= 0; i--) {
+                if (!(fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+                ssize_t leidos = read(conexiones[i].conexion->fd, buffer.data(), buffer.size());
+                if (leidos <= 0) {
+                    conexiones.erase(conexiones.begin() + i);
+                    continue;
+                }
+                conexiones[i].pendiente.append(buffer.data(), leidos);
+                separarPedidos(conexiones[i], pedidos);
+                if (conexiones[i].pendiente.size() > static_cast<size_t>(BUFFER_SOCKET)) {
+                    conexiones.erase(conexiones.begin() + i); // Una línea así no es un puzzle
+                }
             }
+            encolar(pedidos);
 
-            board[row][col] = 0;
+            if (fds[0].revents & POLLIN) {
+                int fd = accept(escucha, nullptr, nullptr);
+                if (fd >= 0) {
+                    conexiones.push_back({ std::make_shared<ConexionServicio>(fd), std::string() });
+                    metricas.conexiones++;
+                }
+            }
         }
     }
-    return false;
-}
 
-// Función para inicializar un tablero con memoria dinámica
-int** initializeBoardp(const std::vector<std::vector<int>>& initialBoard) {
-    int size = initialBoard.size();
-    int** board = new int* [size];
-    for (int i = 0; i < size; i++) {
-        board[i] = new int[size];
-        for (int j = 0; j < size; j++) {
-            board[i][j] = initialBoard[i][j];
+    // Toma un lote de la cola: con poca carga un pedido, con mucha hasta LOTE_SERVICIO,
+    // repartiendo lo encolado entre los trabajadores
+    bool tomarLote(std::vector<PedidoServicio>& lote) {
+        std::unique_lock<std::mutex> lock(mtxCola);
+        cvCola.wait(lock, [&] { return !cola.empty() || terminar; });
+        if (cola.empty()) return false;
+        size_t tomar = std::min<size_t>(LOTE_SERVICIO, (cola.size() + numHilos - 1) / numHilos);
+        for (size_t i = 0; i < tomar; i++) {
+            lote.push_back(std::move(cola.front()));
+            cola.pop_front();
         }
+        profundidad.store(cola.size());
+        return true;
     }
-    return board;
-}
 
-// Función para liberar la memoria dinámica del tablero
-void freeBoardp(int** board, int size) {
-    for (int i = 0; i < size; i++) {
-        delete[] board[i];
-    }
-    delete[] board;
-}
+    void trabajador(int id) {
+        ubicarHilo(id);
+        std::unique_ptr<ArenaSolver> arena(new ArenaSolver());
+        for (int size : { N9x9, N16x16, N25x25, N36x36, N49x49, N64x64 }) {
+            despacharOrden(size, [&](auto orden) {
+                arena->para<decltype(orden)::value>();
+                return true;
+            });
+        }
+        std::unique_ptr<Tablero> board(new Tablero());
+        EstadisticasPropagacion stats;
+        std::vector<PedidoServicio> lote;
+        std::string respuesta;
 
-// Función para imprimir el tablero de Sudoku
-void printBoardp(int** board, int size) {
-    std::cout << "{" << std::endl;
-    std::cout << "\t\"board\": [" << std::endl;
-    for (int i = 0; i < size; i++) {
-        std::cout << "\t\t[";
-        for (int j = 0; j < size; j++) {
-            std::cout << board[i][j];
-            if (j != size - 1) std::cout << ", ";
+        while (tomarLote(lote)) {
+            // Las respuestas para un mismo cliente salen juntas en una sola escritura
+            std::stable_sort(lote.begin(), lote.end(), [](const PedidoServicio& a, const PedidoServicio& b) {
+                return a.conexion.get() < b.conexion.get();
+            });
+            size_t i = 0;
+            while (i < lote.size()) {
+                ConexionServicio* conexion = lote[i].conexion.get();
+                respuesta.clear();
+                size_t desde = i;
+                for (; i < lote.size() && lote[i].conexion.get() == conexion; i++) {
+                    responder(lote[i], *board, *arena, stats, respuesta);
+                }
+                metricas.respondidos.fetch_add(i - desde);
+                std::lock_guard<std::mutex> guard(conexion->mtxEscritura);
+                escribirTodo(conexion->fd, respuesta.data(), respuesta.size());
+            }
+            metricas.lotes++;
+            lote.clear();
         }
-        std::cout << "]";
-        if (i != size - 1) std::cout << ",";
-        std::cout << std::endl;
     }
-    std::cout << "\t]" << std::endl;
-    std::cout << "}" << std::endl;
-}
 
+    // Agrega a respuesta la línea que contesta al pedido
+    void responder(const PedidoServicio& pedido, Tablero& board, ArenaSolver& arena, EstadisticasPropagacion& stats,
+        std::string& respuesta) {
+        const std::string& linea = pedido.linea;
+        size_t espacio = linea.find(' ');
+        size_t comienzo = espacio == std::string::npos ? 0 : espacio + 1;
+        VistaLinea puzzle = { linea.data() + comienzo, static_cast<int>(linea.size() - comienzo) };
 
-void resolverSudokup(const std::vector<std::vector<int>>& initialBoard) {
-    int size = initialBoard.size();
-    int** board = initializeBoardp(initialBoard);
+        if (espacio == std::string::npos) respuesta += '-';
+        else respuesta.append(linea, 0, espacio);
+        respuesta += "   ";
+        size_t posEstado = respuesta.size() - 2;
+        size_t posSolucion = respuesta.size();
+        respuesta.resize(posSolucion + puzzle.longitud);
+        ResultadoLinea resultado = resolverLinea(puzzle, &respuesta[posSolucion], board, arena, stats, limites, cache);
 
-    std::cout << "Sudoku a resolver:" << std::endl;
-    printBoardp(board, size);
+        static const char codigos[] = { 'R', 'S', 'I', 'A' };
+        int indice = static_cast<int>(resultado);
+        respuesta[posEstado] = codigos[indice];
+        metricas.porEstado[indice].fetch_add(1, std::memory_order_relaxed);
+        if (resultado != ResultadoLinea::Invalido
+            && limites.motorPara(dimensionDesdeLongitud(puzzle.longitud)) != limites.motor) {
+            metricas.conPropagacion.fetch_add(1, std::memory_order_relaxed);
+        }
+        long long us = static_cast<long long>(nanosegundosDesde(pedido.llegada) / 1000);
+        metricas.registrarLatencia(us);
+        respuesta += ' ';
+        respuesta += std::to_string(us);
+        respuesta += '\n';
+    }
+};
+
+// Resumen de una corrida del generador de carga
+struct ReporteCliente {
+    long long enviados = 0;
+    long long respondidos = 0;
+    long long porEstado[4] = {};
+    long long incorrectos = 0;  // Resueltos cuya solución no cumple las reglas o no respeta las pistas
+    double segundos = 0;
+    double p50ns = 0;           // Ida y vuelta vista por el cliente
+    double p99ns = 0;
+    std::string metricasServidor;
+};
+
+int conectarServicio(const std::string& ruta) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_un direccion;
+    std::memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    std::strncpy(direccion.sun_path, ruta.c_str(), sizeof(direccion.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
 
-    auto start = std::chrono::high_resolution_clock::now();
+// Lee del socket hasta completar una línea; `pendiente` guarda lo que sobró de la lectura anterior
+bool leerLineaSocket(int fd, std::string& pendiente, std::string& linea) {
+    char buffer[BUFFER_SOCKET];
+    size_t salto;
+    while ((salto = pendiente.find('\n')) == std::string::npos) {
+        ssize_t leidos = read(fd, buffer, sizeof(buffer));
+        if (leidos <= 0) return false;
+        pendiente.append(buffer, leidos);
+    }
+    linea.assign(pendiente, 0, salto);
+    pendiente.erase(0, salto + 1);
+    return true;
+}
 
-    // Usar futuros para asegurar que todos los hilos terminen antes de medir el tiempo
-    std::vector<std::future<bool>> futures;
-    for (int i = 0; i < 8; ++i) {
-        futures.push_back(std::async(std::launch::async, solveSudokup, board, size, 0, 0));
+// Generador de carga: manda los puzzles del archivo `repeticiones` veces repartidos en varias
+// conexiones, cada una con hasta `ventana` pedidos en vuelo, y verifica cada solución.
+bool ejecutarCliente(const std::string& rutaSocket, const std::string& rutaPuzzles, int numConexiones, int ventana,
+    int repeticiones, ReporteCliente& reporte) {
+    ArchivoMapeado archivo;
+    if (!mapearArchivo(rutaPuzzles, archivo)) return false;
+    std::vector<VistaLinea> puzzles;
+    const char* cursor = archivo.datos;
+    const char* fin = archivo.datos + archivo.longitud;
+    while (cursor < fin) {
+        const char* salto = static_cast<const char*>(std::memchr(cursor, '\n', fin - cursor));
+        const char* finLinea = salto ? salto : fin;
+        int longitud = static_cast<int>(finLinea - cursor);
+        if (longitud > 0 && cursor[longitud - 1] == '\r') longitud--;
+        if (longitud > 0 && cursor[0] != '#') puzzles.push_back({ cursor, longitud });
+        cursor = salto ? salto + 1 : fin;
     }
-    for (auto& f : futures) {
-        f.get(); // Espera a que todos los hilos terminen
+    long long total = static_cast<long long>(puzzles.size()) * repeticiones;
+    reporte = ReporteCliente();
+    if (total == 0) {
+        liberarArchivo(archivo);
+        return true;
     }
 
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::vector<double> latencias(total);
+    std::vector<ReporteCliente> parciales(numConexiones);
+    std::atomic<bool> fallo{ false };
+    auto inicio = std::chrono::steady_clock::now();
+
+    // La conexión k manda los pedidos k, k + numConexiones, ...; el id es el índice global
+    auto conexion = [&](int k) {
+        int fd = conectarServicio(rutaSocket);
+        if (fd < 0) {
+            fallo = true;
+            return;
+        }
+        ReporteCliente& parcial = parciales[k];
+        std::vector<std::chrono::steady_clock::time_point> envio(total);
+        std::string salida, pendiente, linea;
+        Tablero puzzle, solucion;
+        long long siguiente = k;
+        long long enVuelo = 0;
+        while (siguiente < total || enVuelo > 0) {
+            // Completar la ventana con una sola escritura
+            salida.clear();
+            auto ahora = std::chrono::steady_clock::now();
+            while (siguiente < total && enVuelo < ventana) {
+                const VistaLinea& p = puzzles[siguiente % puzzles.size()];
+                salida += std::to_string(siguiente);
+                salida += ' ';
+                salida.append(p.inicio, p.longitud);
+                salida += '\n';
+                envio[siguiente] = ahora;
+                siguiente += numConexiones;
+                enVuelo++;
+                parcial.enviados++;
+            }
+            if (!salida.empty() && !escribirTodo(fd, salida.data(), salida.size())) break;
 
-    int hours = duration_ms / 3600000;
-    int minutes = (duration_ms % 3600000) / 60000;
-    int seconds = (duration_ms % 60000) / 1000;
-    int milliseconds = duration_ms % 1000;
+            // Esperar al menos una respuesta y tomar todas las que ya llegaron
+            do {
+                if (!leerLineaSocket(fd, pendiente, linea)) {
+                    fallo = true;
+                    close(fd);
+                    return;
+                }
+                char* resto;
+                long long id = std::strtoll(linea.c_str(), &resto, 10);
+                if (id < 0 || id >= total || *resto != ' ' || resto[1] == '\0') continue;
+                latencias[id] = nanosegundosDesde(envio[id]);
+                enVuelo--;
+                parcial.respondidos++;
+                char estado = resto[1];
+                const char* codigos = "RSIA";
+                const char* indice = std::strchr(codigos, estado);
+                if (indice) parcial.porEstado[indice - codigos]++;
+                if (estado == 'R') {
+                    const VistaLinea& p = puzzles[id % puzzles.size()];
+                    const char* texto = resto + 3;
+                    bool correcto = static_cast<int>(std::strlen(texto)) > p.longitud;
+                    puzzle.size = solucion.size = dimensionDesdeLongitud(p.longitud);
+                    for (int pos = 0; correcto && pos < p.longitud; pos++) {
+                        puzzle.celdas[pos] = static_cast<uint8_t>(valorDesdeCaracter(p.inicio[pos], puzzle.size));
+                        solucion.celdas[pos] = static_cast<uint8_t>(valorDesdeCaracter(texto[pos], puzzle.size));
+                    }
+                    if (!correcto || !solucionCorrecta(puzzle, solucion)) parcial.incorrectos++;
+                }
+            } while (pendiente.find('\n') != std::string::npos);
+        }
+        close(fd);
+    };
 
-    std::cout << "Sudoku resuelto exitosamente en ";
-    if (hours > 0) {
-        std::cout << hours << " horas, " << minutes << " minutos, " << seconds << " segundos y " << milliseconds << " milisegundos." << std::endl;
-    }
-    else if (minutes > 0) {
-        std::cout << minutes << " minutos, " << seconds << " segundos y " << milliseconds << " milisegundos." << std::endl;
-    }
-    else if (seconds > 0) {
-        std::cout << seconds << " segundos y " << milliseconds << " milisegundos." << std::endl;
+    std::vector<std::thread> hilos;
+    for (int k = 0; k < numConexiones; k++) hilos.emplace_back(conexion, k);
+    for (auto& t : hilos) t.join();
+    reporte.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    liberarArchivo(archivo);
+
+    for (const ReporteCliente& parcial : parciales) {
+        reporte.enviados += parcial.enviados;
+        reporte.respondidos += parcial.respondidos;
+        reporte.incorrectos += parcial.incorrectos;
+        for (int i = 0; i < 4; i++) reporte.porEstado[i] += parcial.porEstado[i];
     }
-    else {
-        std::cout << milliseconds << " milisegundos." << std::endl;
+    latencias.resize(reporte.respondidos == total ? total : 0);
+    reporte.p50ns = percentil(latencias, 0.50);
+    reporte.p99ns = percentil(latencias, 0.99);
+
+    // Las métricas del servidor al terminar, por una conexión aparte
+    int fd = conectarServicio(rutaSocket);
+    if (fd >= 0) {
+        std::string pendiente;
+        const char pedido[] = "#metricas\n";
+        if (escribirTodo(fd, pedido, sizeof(pedido) - 1)) leerLineaSocket(fd, pendiente, reporte.metricasServidor);
+        close(fd);
     }
+    return !fallo;
+}
 
-    printBoardp(board, size);
-    freeBoardp(board, size);
+void imprimirReporteCliente(const ReporteCliente& reporte, std::ostream& os) {
+    os << "Cliente: " << reporte.respondidos << " de " << reporte.enviados << " pedidos respondidos ("
+        << reporte.porEstado[0] << " resueltos, " << reporte.porEstado[1] << " sin solución, "
+        << reporte.porEstado[2] << " inválidos, " << reporte.porEstado[3] << " agotados, "
+        << reporte.incorrectos << " incorrectos) en " << std::fixed << std::setprecision(3)
+        << reporte.segundos << " s" << std::endl;
+    os << "Rendimiento: " << std::setprecision(1)
+        << (reporte.segundos > 0 ? reporte.respondidos / reporte.segundos : 0) << " pedidos/s" << std::endl;
+    os << "Ida y vuelta: p50 = " << reporte.p50ns / 1000.0 << " us, p99 = " << reporte.p99ns / 1000.0 << " us" << std::endl;
+    os << std::defaultfloat;
+    if (!reporte.metricasServidor.empty()) os << "Servidor: " << reporte.metricasServidor << std::endl;
 }
+#endif
 
 
 
@@ -414,11 +5898,11 @@ std::vector<std::vector<int>> board25x25_dificultad_media = {
 };
 
 // Llamada a la función `resolverSudoku` pasando el objeto `board25x25_dificultad_media`
-void resolver25x25() {
-    resolverSudoku(board25x25_dificultad_media);
+void resolver25x25(Motor motor = Motor::Clasico, bool preprocesar = false) {
+    resolverSudoku(board25x25_dificultad_media, motor, preprocesar);
 }
 void resolver25x25p() {
-    resolverSudoku(board25x25_dificultad_media);
+    resolverSudokup(board25x25_dificultad_media);
 }
 
 
@@ -444,11 +5928,11 @@ std::vector<std::vector<int>> board16x16_dificultad_media = {
 };
 
 // Llamada a la función `resolverSudoku` pasando el objeto `board16x16_dificultad_media`
-void resolver16x16() {
-    resolverSudoku(board16x16_dificultad_media);
+void resolver16x16(Motor motor = Motor::Clasico, bool preprocesar = false) {
+    resolverSudoku(board16x16_dificultad_media, motor, preprocesar);
 }
 void resolver16x16p() {
-    resolverSudoku(board16x16_dificultad_media);
+    resolverSudokup(board16x16_dificultad_media);
 }
 
 
@@ -467,15 +5951,53 @@ std::vector<std::vector<int>> board9x9_dificultad_media = {
 };
 
 // Llamada a la función `resolverSudoku` pasando el objeto `board9x9_dificultad_media`
-void resolver9x9() {
-    resolverSudoku(board9x9_dificultad_media);
+void resolver9x9(Motor motor = Motor::Clasico, bool preprocesar = false) {
+    resolverSudoku(board9x9_dificultad_media, motor, preprocesar);
 }
 void resolver9x9p() {
-    resolverSudoku(board9x9_dificultad_media);
+    resolverSudokup(board9x9_dificultad_media);
 }
 
 
 
+// Submenú para elegir el motor de resolución
+Motor elegirMotor() {
+    int opcionMotor;
+    std::cout << "\n=== Elija el motor de resolución ===" << std::endl;
+    std::cout << "1. Clásico (isSafe)" << std::endl;
+    std::cout << "2. Máscaras de bits" << std::endl;
+    std::cout << "3. Máscaras de bits con MRV (menos candidatos primero)" << std::endl;
+    std::cout << "4. Propagación de restricciones en cada nodo" << std::endl;
+    std::cout << "5. Dancing Links (cobertura exacta)" << std::endl;
+    std::cout << "6. Portafolio (una estrategia por hilo, gana la primera)" << std::endl;
+    std::cout << "Elija una opción: ";
+    std::cin >> opcionMotor;
+
+    switch (opcionMotor) {
+    case 6:
+        return Motor::Portafolio;
+    case 5:
+        return Motor::DLX;
+    case 4:
+        return Motor::Propagacion;
+    case 3:
+        return Motor::MRV;
+    case 2:
+        return Motor::Bitmask;
+    case 1:
+    default:
+        return Motor::Clasico;
+    }
+}
+
+// Pregunta si se propaga antes de entregar el tablero al motor
+bool elegirPreprocesado() {
+    int opcion;
+    std::cout << "\n¿Propagar restricciones antes de resolver? (1. Sí / 2. No): ";
+    std::cin >> opcion;
+    return opcion == 1;
+}
+
 // Menú principal
 void menuPrincipal() {
     int opcionPrincipal;
@@ -485,12 +6007,13 @@ void menuPrincipal() {
         std::cout << "=== MENU PRINCIPAL ===" << std::endl;
         std::cout << "1. Solucionar Sudoku sin paralelizar" << std::endl;
         std::cout << "2. Solucionar Sudoku con técnicas de paralelización (por filas)" << std::endl;
-        std::cout << "3. Verificar cantidad de hilos disponibles" << std::endl;
-        std::cout << "4. Salir" << std::endl;
+        std::cout << "3. Ver las CPUs y los hilos disponibles" << std::endl;
+        std::cout << "4. Solucionar Sudoku en paralelo (pool de hilos con robo de trabajo)" << std::endl;
+        std::cout << "5. Salir" << std::endl;
         std::cout << "Elija una opción: ";
         std::cin >> opcionPrincipal;
 
-        if (opcionPrincipal == 4) {
+        if (opcionPrincipal == 5) {
             std::cout << "Saliendo del programa..." << std::endl;
             break;
         }
@@ -503,31 +6026,28 @@ void menuPrincipal() {
             std::cout << "3. Sudoku 25x25" << std::endl;
             std::cout << "Elija una opción: ";
             std::cin >> opcionSudoku;
+            Motor motor = elegirMotor();
+            bool preprocesar = elegirPreprocesado();
 
-            auto start = std::chrono::high_resolution_clock::now();
             switch (opcionSudoku) {
             case 1:
-                resolver9x9p();
+                resolver9x9(motor, preprocesar);
                 break;
             case 2:
-                resolver16x16p();
+                resolver16x16(motor, preprocesar);
                 break;
             case 3:
-                resolver25x25p();
+                resolver25x25(motor, preprocesar);
                 break;
                 // Añadir más casos para 16x16 y 25x25 según sea necesario.
             default:
                 std::cout << "Opción no válida." << std::endl;
                 continue;
             }
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-            std::cout << "Tiempo para resolver el Sudoku: " << duration_ms << " ms" << std::endl;
-          
             break;
         }
 
-        case 2: {  // Resolver Sudoku con paralelización por filas aleatorias
+        case 2: {  // Resolver Sudoku con paralelización por filas
             std::cout << "\n=== Elija el tamaño del Sudoku ===" << std::endl;
             std::cout << "1. Sudoku 9x9" << std::endl;
             std::cout << "2. Sudoku 16x16" << std::endl;
@@ -535,42 +6055,68 @@ void menuPrincipal() {
             std::cout << "Elija una opción: ";
             std::cin >> opcionSudoku;
 
-            auto start = std::chrono::high_resolution_clock::now();
+            // Se resuelve una copia para no modificar los tableros de ejemplo
+            Tablero board;
             switch (opcionSudoku) {
             case 1:
-                resolverSudokuPorFilasAleatorias(board9x9_dificultad_media);
-                printBoard(board9x9_dificultad_media);  // Imprimir Sudoku resuelto
+                cargarTablero(board9x9_dificultad_media, board);
                 break;
             case 2:
-                resolverSudokuPorFilasAleatorias(board16x16_dificultad_media);
-                printBoard(board16x16_dificultad_media);  // Imprimir Sudoku resuelto
+                cargarTablero(board16x16_dificultad_media, board);
                 break;
             case 3:
-                resolverSudokuPorFilasAleatorias(board25x25_dificultad_media);
-                printBoard(board25x25_dificultad_media);  // Imprimir Sudoku resuelto
+                cargarTablero(board25x25_dificultad_media, board);
                 break;
             default:
                 std::cout << "Opción no válida." << std::endl;
                 continue;
             }
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-            std::cout << "Tiempo para resolver el Sudoku: " << duration_ms << " ms" << std::endl;
+
+            EstadisticasPropagacion estadisticas;
+            std::unique_ptr<ArenaSolver> arena(new ArenaSolver());
+            auto inicio = std::chrono::steady_clock::now();
+            bool resuelto = resolverSudokuPorFilas(board, *arena, &estadisticas);
+            double ns = nanosegundosDesde(inicio);
+            if (resuelto) {
+                printBoardCuadricula(board);  // Imprimir Sudoku resuelto
+            }
+            else {
+                std::cout << "No se pudo resolver el Sudoku." << std::endl;
+            }
+            imprimirEstadisticas(estadisticas);
+            std::cout << "Tiempo para resolver el Sudoku: " << formatearDuracion(ns) << std::endl;
             break;
         }
 
+        case 4: {
+            std::cout << "\n=== Elija el tamaño del Sudoku ===" << std::endl;
+            std::cout << "1. Sudoku 9x9" << std::endl;
+            std::cout << "2. Sudoku 16x16" << std::endl;
+            std::cout << "3. Sudoku 25x25" << std::endl;
+            std::cout << "Elija una opción: ";
+            std::cin >> opcionSudoku;
 
-        case 3: {
-            unsigned int numHilos = std::thread::hardware_concurrency();
-            if (numHilos == 0) {
-                std::cout << "No se pudo determinar el número de hilos disponibles." << std::endl;
-            }
-            else {
-                std::cout << "Número de hilos disponibles: " << numHilos << std::endl;
+            switch (opcionSudoku) {
+            case 1:
+                resolver9x9p();
+                break;
+            case 2:
+                resolver16x16p();
+                break;
+            case 3:
+                resolver25x25p();
+                break;
+            default:
+                std::cout << "Opción no válida." << std::endl;
+                continue;
             }
             break;
         }
 
+        case 3:
+            imprimirTopologia(std::cout);
+            break;
+
         default:
             std::cout << "Opción no válida." << std::endl;
             break;
@@ -580,7 +6126,391 @@ void menuPrincipal() {
     }
 }
 
-int main() {
-    menuPrincipal();
+// Traduce el nombre usado en la línea de comandos a un motor
+bool motorDesdeNombre(const std::string& nombre, Motor& motor) {
+    if (nombre == "clasico") motor = Motor::Clasico;
+    else if (nombre == "bitmask") motor = Motor::Bitmask;
+    else if (nombre == "mrv") motor = Motor::MRV;
+    else if (nombre == "propagacion") motor = Motor::Propagacion;
+    else if (nombre == "dlx") motor = Motor::DLX;
+    else if (nombre == "paralelo") motor = Motor::Paralelo;
+    else if (nombre == "portafolio") motor = Motor::Portafolio;
+    else return false;
+    return true;
+}
+
+void mostrarUso(const char* programa) {
+    std::cout << "Uso: " << programa << " [--motor=clasico|bitmask|mrv|propagacion|dlx|paralelo|portafolio] [--tamano=9|16|25] [--propagar]" << std::endl;
+    std::cout << "     " << programa << " --contar=N [--tamano=9|16|25]  (cuenta soluciones hasta N; 2 verifica unicidad)" << std::endl;
+    std::cout << "     " << programa << " --lote=puzzles.txt [--salida=soluciones.txt] [--motor=...]  (por omisión, propagacion;" << std::endl;
+    std::cout << "               con dlx, los mayores que 25x25 van por propagacion)" << std::endl;
+    std::cout << "     " << programa << " --convertir=puzzles.txt --salida=puzzles.sdb  (líneas, JSON o binario; la salida según su extensión)" << std::endl;
+    std::cout << "     " << programa << " --probar  (autoverificación: formato binario, caché y sesión)" << std::endl;
+    std::cout << "     " << programa << " --sesion  (edición interactiva por la entrada estándar: tablero, poner, borrar, resoluble," << std::endl;
+    std::cout << "               unica, pista, candidatos, mostrar, solucion)" << std::endl;
+    std::cout << "     " << programa << " --generar=N [--tamano=9|16|25|36|49|64] [--dificultad=facil|media|dificil|diabolica] [--semilla=S] [--salida=puzzles.txt]" << std::endl;
+    std::cout << "     " << programa << " --bench[=9|16|25|36|49|64] [--repeticiones=R] [--calentamiento=W] [--formato=texto|json|csv] [--salida=bench.json]" << std::endl;
+#ifndef _WIN32
+    std::cout << "     " << programa << " --servir=/tmp/sudoku.sock  (servicio por socket: pedidos \"<id> <puzzle>\" por línea)" << std::endl;
+    std::cout << "     " << programa << " --cliente=/tmp/sudoku.sock --lote=puzzles.txt [--conexiones=C] [--ventana=W] [--repeticiones=R]" << std::endl;
+#endif
+    std::cout << "Con --traza=arbol.csv [--muestreo=N] se guarda uno de cada N nodos de la búsqueda (compilación instrumentada)." << std::endl;
+    std::cout << "Con --plazo=MS y/o --presupuesto=NODOS la búsqueda se abandona al vencer el plazo o agotar los nodos" << std::endl;
+    std::cout << "(por puzzle en --lote; con un solo tablero, solo con --motor=propagacion, paralelo o portafolio) y muestra hasta dónde llegó." << std::endl;
+    std::cout << "Con --motor=portafolio cada hilo corre una estrategia distinta sobre el mismo puzzle y gana el primero;" << std::endl;
+    std::cout << "--estrategias=propagacion,luby,dlx,mrv fija las de los primeros hilos (el resto corre luby con otra semilla)" << std::endl;
+    std::cout << "y al final se muestran las victorias de cada una." << std::endl;
+    std::cout << "Con --cache=N se guardan hasta N soluciones por forma canónica (simetrías y renombre de dígitos)" << std::endl;
+    std::cout << "y un puzzle equivalente a uno ya resuelto sale de la caché (--lote, --servir y un solo tablero)." << std::endl;
+    std::cout << "Los archivos .sdb usan el formato binario compacto; --lote los acepta como entrada y como salida" << std::endl;
+    std::cout << "(igual que .json), y en la salida cada tablero lleva la marca de si se resolvió." << std::endl;
+    std::cout << "Con --hilos=N los motores paralelos usan N hilos (por omisión, uno por CPU); --sin-smt usa un hilo por" << std::endl;
+    std::cout << "núcleo físico y --fijar fija cada hilo a una CPU (llenando un nodo NUMA antes de pasar al siguiente)." << std::endl;
+    std::cout << "     " << programa << " --escalado[=9|16|25|36|49|64] [--hilos=N] [--fijar] [--sin-smt]  (aceleración por cantidad de hilos)" << std::endl;
+    std::cout << "Con --escalar no se usan los núcleos AVX2 aunque la CPU los tenga." << std::endl;
+    std::cout << "Sin argumentos se abre el menú interactivo." << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 1) {
+        menuPrincipal();
+        return 0;
+    }
+
+    // Modo no interactivo: resolver el tablero de ejemplo indicado con el motor pedido
+    Motor motor = Motor::Clasico;
+    bool motorElegido = false;
+    int tamano = N9x9;
+    bool preprocesar = false;
+    long long limiteConteo = 0;
+    long long cantidadGenerar = 0;
+    Dificultad dificultad = Dificultad::Media;
+    uint64_t semilla = 1;
+    bool bench = false;
+    std::string rutaTraza;
+    long long muestreo = 1;
+    OpcionesBench opcionesBench;
+    LimitesResolucion limites;
+    std::string rutaLote;
+    std::string rutaSalida;
+    std::string rutaServicio;
+    std::string rutaCliente;
+    std::string rutaConvertir;
+    bool sesion = false;
+    bool probar = false;
+    int conexiones = 4;
+    int ventana = 64;
+    int repeticionesCliente = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--motor=", 0) == 0) {
+            motorElegido = true;
+            if (!motorDesdeNombre(arg.substr(8), motor)) {
+                std::cout << "Motor desconocido: " << arg.substr(8) << std::endl;
+                mostrarUso(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.rfind("--tamano=", 0) == 0) {
+            tamano = std::atoi(arg.c_str() + 9);
+        }
+        else if (arg == "--propagar") {
+            preprocesar = true;
+        }
+        else if (arg.rfind("--lote=", 0) == 0) {
+            rutaLote = arg.substr(7);
+        }
+        else if (arg.rfind("--salida=", 0) == 0) {
+            rutaSalida = arg.substr(9);
+        }
+        else if (arg.rfind("--contar=", 0) == 0) {
+            limiteConteo = std::atoll(arg.c_str() + 9);
+            if (limiteConteo <= 0) {
+                mostrarUso(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.rfind("--generar=", 0) == 0) {
+            cantidadGenerar = std::atoll(arg.c_str() + 10);
+            if (cantidadGenerar <= 0) {
+                mostrarUso(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.rfind("--dificultad=", 0) == 0) {
+            if (!dificultadDesdeNombre(arg.substr(13), dificultad)) {
+                std::cout << "Dificultad desconocida: " << arg.substr(13) << std::endl;
+                mostrarUso(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.rfind("--semilla=", 0) == 0) {
+            semilla = std::strtoull(arg.c_str() + 10, nullptr, 10);
+        }
+        else if (arg == "--bench" || arg.rfind("--bench=", 0) == 0) {
+            bench = true;
+            if (arg.size() > 8) opcionesBench.tamano = std::atoi(arg.c_str() + 8);
+        }
+        else if (arg.rfind("--repeticiones=", 0) == 0) {
+            opcionesBench.repeticiones = std::max(1, std::atoi(arg.c_str() + 15));
+            repeticionesCliente = opcionesBench.repeticiones;
+        }
+        else if (arg.rfind("--calentamiento=", 0) == 0) {
+            opcionesBench.calentamiento = std::max(0, std::atoi(arg.c_str() + 16));
+        }
+        else if (arg.rfind("--formato=", 0) == 0) {
+            opcionesBench.formato = arg.substr(10);
+            if (opcionesBench.formato != "texto" && opcionesBench.formato != "json" && opcionesBench.formato != "csv") {
+                mostrarUso(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.rfind("--traza=", 0) == 0) {
+            rutaTraza = arg.substr(8);
+        }
+        else if (arg.rfind("--muestreo=", 0) == 0) {
+            muestreo = std::max(1LL, std::atoll(arg.c_str() + 11));
+        }
+        else if (arg.rfind("--plazo=", 0) == 0) {
+            limites.plazoSegundos = std::atof(arg.c_str() + 8) / 1000.0;
+            if (limites.plazoSegundos <= 0) {
+                mostrarUso(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.rfind("--presupuesto=", 0) == 0) {
+            limites.presupuestoNodos = std::atoll(arg.c_str() + 14);
+            if (limites.presupuestoNodos <= 0) {
+                mostrarUso(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg.rfind("--cache=", 0) == 0) {
+            long long capacidad = std::atoll(arg.c_str() + 8);
+            if (capacidad <= 0) {
+                mostrarUso(argv[0]);
+                return 1;
+            }
+            cacheSoluciones.reset(new CacheSoluciones(capacidad));
+        }
+        else if (arg.rfind("--servir=", 0) == 0) {
+            rutaServicio = arg.substr(9);
+        }
+        else if (arg.rfind("--cliente=", 0) == 0) {
+            rutaCliente = arg.substr(10);
+        }
+        else if (arg.rfind("--convertir=", 0) == 0) {
+            rutaConvertir = arg.substr(12);
+        }
+        else if (arg == "--sesion") {
+            sesion = true;
+        }
+        else if (arg == "--probar") {
+            probar = true;
+        }
+        else if (arg.rfind("--conexiones=", 0) == 0) {
+            conexiones = std::max(1, std::atoi(arg.c_str() + 13));
+        }
+        else if (arg.rfind("--ventana=", 0) == 0) {
+            ventana = std::max(1, std::atoi(arg.c_str() + 10));
+        }
+        else if (arg == "--escalar") {
+            usarAVX2 = false;
+        }
+        else if (arg.rfind("--hilos=", 0) == 0) {
+            opcionesHilos.hilos = std::atoi(arg.c_str() + 8);
+            if (opcionesHilos.hilos <= 0) {
+                mostrarUso(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--fijar") {
+#ifdef __linux__
+            opcionesHilos.fijar = true;
+#else
+            std::cerr << "--fijar solo está disponible en Linux; se ignora" << std::endl;
+#endif
+        }
+        else if (arg == "--sin-smt") {
+            opcionesHilos.sinSMT = true;
+        }
+        else if (arg == "--escalado" || arg.rfind("--escalado=", 0) == 0) {
+            bench = true;
+            opcionesBench.soloEscalado = true;
+            if (arg.size() > 11) opcionesBench.tamano = std::atoi(arg.c_str() + 11);
+        }
+        else if (arg.rfind("--estrategias=", 0) == 0) {
+            mezclaPortafolio.clear();
+            std::istringstream lista(arg.substr(14));
+            std::string nombre;
+            while (std::getline(lista, nombre, ',')) {
+                Estrategia estrategia;
+                if (!estrategiaDesdeNombre(nombre, estrategia)) {
+                    std::cout << "Estrategia desconocida: " << nombre << std::endl;
+                    mostrarUso(argv[0]);
+                    return 1;
+                }
+                mezclaPortafolio.push_back(estrategia);
+            }
+        }
+        else {
+            mostrarUso(argv[0]);
+            return arg == "--ayuda" ? 0 : 1;
+        }
+    }
+
+#if SUDOKU_INSTRUMENTACION
+    // La traza se prepara antes de elegir el modo y se vuelca al salir de main, sea cual sea
+    // (también en lote y en servicio, que vuelven antes que los demás)
+    struct VolcadoTraza {
+        std::string ruta;
+        ~VolcadoTraza() {
+            if (!ruta.empty() && !volcarTraza(ruta)) std::cerr << "No se pudo escribir " << ruta << std::endl;
+        }
+    } volcado{ rutaTraza };
+    if (!rutaTraza.empty()) muestreoTraza = muestreo;
+#else
+    if (!rutaTraza.empty() || muestreo > 1) {
+        std::cerr << "La traza necesita una compilación instrumentada (sin NDEBUG o con -DSUDOKU_INSTRUMENTACION=1)" << std::endl;
+        return 1;
+    }
+#endif
+
+    // En lote y en servicio cada puzzle va con el motor pedido, o con propagación si no se eligió
+    // ninguno. Los límites los revisan todos salvo el clásico y el de máscaras.
+    if (!rutaLote.empty() || !rutaServicio.empty()) {
+        if (!motorElegido) motor = Motor::Propagacion;
+        if (limites.activos() && (motor == Motor::Clasico || motor == Motor::Bitmask)) {
+            std::cout << "--plazo y --presupuesto no se pueden usar con --motor=clasico ni bitmask" << std::endl;
+            return 1;
+        }
+    }
+    limites.motor = motor;
+    if (motor == Motor::Portafolio) limites.portafolio = true;
+    if (limites.hilosPorPuzzle()) limites.hilos = hilosDisponibles();
+
+    if (!rutaServicio.empty() || !rutaCliente.empty()) {
+#ifdef _WIN32
+        std::cerr << "El modo servicio necesita sockets de dominio Unix" << std::endl;
+        return 1;
+#else
+        if (!rutaServicio.empty()) {
+            ServicioSudoku servicio(rutaServicio, limites, hilosDisponibles(), cacheSoluciones.get());
+            if (!servicio.ejecutar()) {
+                std::cerr << "No se pudo escuchar en " << rutaServicio << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+        if (rutaLote.empty()) {
+            mostrarUso(argv[0]);
+            return 1;
+        }
+        ReporteCliente reporte;
+        bool ok = ejecutarCliente(rutaCliente, rutaLote, conexiones, ventana, repeticionesCliente, reporte);
+        imprimirReporteCliente(reporte, std::cout);
+        if (!ok) std::cerr << "No se pudo leer " << rutaLote << " o hablar con el servicio en " << rutaCliente << std::endl;
+        return ok ? 0 : 1;
+#endif
+    }
+
+    if (sesion) {
+        ejecutarSesion(std::cin, std::cout);
+        return 0;
+    }
+
+    if (probar) return ejecutarPruebas(std::cout) ? 0 : 1;
+
+    if (!rutaConvertir.empty()) {
+        ReporteConversion reporte;
+        if (!convertirTableros(rutaConvertir, rutaSalida, reporte)) {
+            std::cerr << "No se pudo leer " << rutaConvertir << " (o está dañado) o escribir la salida" << std::endl;
+            return 1;
+        }
+        imprimirReporteConversion(reporte, rutaSalida.empty() ? std::cerr : std::cout);
+        return 0;
+    }
+
+    if (!rutaLote.empty()) {
+        ReporteLote reporte;
+        // Las líneas van por el camino mapeado en memoria; los demás formatos, por los lectores
+        bool soloLineas = formatoDeEntrada(rutaLote) == FormatoTablero::Lineas
+            && formatoDeSalida(rutaSalida) == FormatoTablero::Lineas;
+        if (!(soloLineas ? resolverLote(rutaLote, rutaSalida, reporte, limites, cacheSoluciones.get())
+            : resolverFlujo(rutaLote, rutaSalida, reporte, limites, cacheSoluciones.get()))) {
+            std::cerr << "No se pudo leer " << rutaLote << " o escribir la salida" << std::endl;
+            return 1;
+        }
+        // Si las soluciones van a la salida estándar el reporte va a la de errores
+        imprimirReporteLote(reporte, rutaSalida.empty() ? std::cerr : std::cout);
+        if (cacheSoluciones) imprimirEstadisticasCache(cacheSoluciones->estadisticas(), rutaSalida.empty() ? std::cerr : std::cout);
+        if (limites.portafolio) imprimirEstadisticasPortafolio(estadisticasPortafolio, rutaSalida.empty() ? std::cerr : std::cout);
+        return 0;
+    }
+
+    if (bench) {
+        std::vector<MedicionBench> mediciones = ejecutarBench(opcionesBench);
+        std::ofstream archivo;
+        if (!rutaSalida.empty()) archivo.open(rutaSalida);
+        std::ostream& os = rutaSalida.empty() ? std::cout : archivo;
+        if (opcionesBench.formato == "json") escribirBenchJSON(opcionesBench, mediciones, os);
+        else if (opcionesBench.formato == "csv") escribirBenchCSV(mediciones, os);
+        else if (opcionesBench.soloEscalado) escribirEscalado(mediciones, os);
+        else escribirBenchTexto(mediciones, os);
+        return os ? 0 : 1;
+    }
+
+    if (cantidadGenerar > 0) {
+        ReporteGeneracion reporte;
+        if (!generarLote(tamano, cantidadGenerar, dificultad, semilla, rutaSalida, reporte)) {
+            std::cerr << "Tamaño no soportado o no se pudo escribir la salida" << std::endl;
+            return 1;
+        }
+        imprimirReporteGeneracion(reporte, rutaSalida.empty() ? std::cerr : std::cout);
+        return 0;
+    }
+
+    if (limiteConteo > 0) {
+        switch (tamano) {
+        case N9x9: contarSudoku(board9x9_dificultad_media, limiteConteo); return 0;
+        case N16x16: contarSudoku(board16x16_dificultad_media, limiteConteo); return 0;
+        case N25x25: contarSudoku(board25x25_dificultad_media, limiteConteo); return 0;
+        default:
+            std::cout << "Tamaño no soportado: " << tamano << std::endl;
+            return 1;
+        }
+    }
+
+    if (limites.activos()) {
+        // Los límites los respeta la búsqueda con propagación, secuencial, paralela o en portafolio
+        if (motor != Motor::Propagacion && motor != Motor::Paralelo && motor != Motor::Portafolio) {
+            std::cout << "--plazo y --presupuesto necesitan --motor=propagacion, paralelo o portafolio" << std::endl;
+            return 1;
+        }
+        limites.hilos = motor == Motor::Propagacion ? 1 : hilosDisponibles();
+        switch (tamano) {
+        case N9x9: resolverSudokuConLimites(board9x9_dificultad_media, limites); return 0;
+        case N16x16: resolverSudokuConLimites(board16x16_dificultad_media, limites); return 0;
+        case N25x25: resolverSudokuConLimites(board25x25_dificultad_media, limites); return 0;
+        default:
+            std::cout << "Tamaño no soportado: " << tamano << std::endl;
+            return 1;
+        }
+    }
+
+    switch (tamano) {
+    case N9x9:
+        resolver9x9(motor, preprocesar);
+        break;
+    case N16x16:
+        resolver16x16(motor, preprocesar);
+        break;
+    case N25x25:
+        resolver25x25(motor, preprocesar);
+        break;
+    default:
+        std::cout << "Tamaño no soportado: " << tamano << std::endl;
+        return 1;
+    }
     return 0;
 }
\ No newline at end of file